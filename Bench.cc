@@ -0,0 +1,404 @@
+///
+/// @file   Bench.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+
+//  Includes
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "CmdLine.hh"
+#include "Client.hh"
+#include "FirmwareImage.hh"
+#include "Gpio.hh"
+#include "Log.hh"
+#include "Metrics.hh"
+#include "Part.hh"
+#include "Session.hh"
+#include "Target.hh"
+#include "Utility.hh"
+
+
+//  External References
+extern  bool        gIsActiveLowReset;
+extern  unsigned    gSyncRetries;
+extern  unsigned    gMaxBaud;
+extern  bool        gIsPipeline;
+extern  isp::FirmwareImage  gImage;
+
+
+//  Type definitions
+typedef struct
+{
+    const char *    name;           ///< Image name in the report
+    uint32_t        span;           ///< Bytes from the first to the last sector
+    uint32_t        islandSize;     ///< Bytes of data in each island
+    uint32_t        islandStride;   ///< Bytes from one island to the next
+} tBenchImage;
+
+
+//  Static variables
+static const tBenchImage sImages[] =
+{
+    { "dense-8k",       8 * 1024,   8 * 1024,   8 * 1024 },
+    { "dense-64k",     64 * 1024,  64 * 1024,  64 * 1024 },
+    { "dense-256k",   256 * 1024, 256 * 1024, 256 * 1024 },
+    { "sparse-256k",  256 * 1024,   4 * 1024,  32 * 1024 },
+};
+
+
+///
+/// @brief      Check both CRC-32 implementations against known answers.
+///
+/// @details    The emulator answers 'S' with its own CRC, so a bench run
+///             alone only shows that the client and the emulator agree.
+///             The answers are those of the IEEE 802.3 CRC-32 given for the
+///             command in the LPC15xx user manual: the standard check value
+///             and a sector of a fixed pattern, worked out with zlib.
+///
+/// @return     Boolean false if either implementation is wrong.
+///
+static bool checkCRC()
+{
+    static const uint8_t sCheck[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    uint8_t sector[ isp::Part::SECTOR_SIZE ];
+    bool    isOK = true;
+
+    for (uint32_t ii = 0U; ii < sizeof(sector); ++ii)
+        sector[ ii ] = static_cast<uint8_t>(ii * 7U + (ii >> 8));
+
+    const struct
+    {
+        const uint8_t * pBlock;
+        size_t          size;
+        uint32_t        crc;
+    } answers[] =
+    {
+        { sCheck,   sizeof(sCheck), 0xCBF43926U },
+        { sector,   sizeof(sector), 0x462C1E21U },
+    };
+
+    for (const auto& answer : answers)
+    {
+        uint32_t client = isp::Utility::crc32(answer.pBlock, answer.size);
+        uint32_t target = isp::Target::crc32(answer.pBlock, answer.size);
+
+        if ((client != answer.crc) || (target != answer.crc))
+        {
+            std::cerr << "CRC-32 of " << answer.size
+                      << " bytes: client 0x" << std::hex << client
+                      << ", target 0x" << target
+                      << ", expected 0x" << answer.crc << std::dec << std::endl;
+            isOK = false;
+        }
+    }
+    return isOK;
+}
+
+
+///
+/// @brief      Build a benchmark image in the firmware image.
+///
+/// @details    Islands of pseudo-random data are separated by gaps that
+///             the image does not hold.  The generator is seeded the same way every
+///             run so the results can be compared between builds.
+///
+/// @param[in]  image
+///             Reference to the image description.
+///
+/// @return     The number of bytes of data in the image.
+///
+static uint32_t makeImage(const tBenchImage& image)
+{
+    uint32_t seed = 0x1549U;
+    uint32_t bytes = 0U;
+
+    gImage.clear();
+    for (uint32_t base = 0U; base < image.span; base += image.islandStride)
+    {
+        uint32_t size = std::min(image.islandSize, image.span - base);
+        uint8_t * pIsland = gImage.reserve(base, size);
+
+        for (uint32_t ii = 0U; ii < size; ++ii)
+        {
+            seed = seed * 1103515245U + 12345U;
+            pIsland[ ii ] = static_cast<uint8_t>(seed >> 16);
+            ++bytes;
+        }
+    }
+
+    gImage.index();
+    return bytes;
+}
+
+
+///
+/// @brief      Run one pass over the emulated target and report it.
+///
+/// @param[in]  device
+///             The pseudo-terminal device of the target.
+///
+/// @param[in]  image
+///             Reference to the image description.
+///
+/// @param[in]  bytes
+///             The number of bytes of data in the image.
+///
+/// @param[in]  pass
+///             The name of the pass in the report.
+///
+/// @param[in]  steps
+///             The bit mask of isp::Session::Step values to run.
+///
+/// @return     The error code of the pass.
+///
+static isp::ISP::Error runPass(const std::string& device,
+                               const tBenchImage& image,
+                               uint32_t bytes,
+                               const char * pass,
+                               unsigned steps)
+{
+    isp::Session    session(device.c_str(), gIsActiveLowReset, false, gMaxBaud);
+    struct timespec start;
+    struct timespec end;
+
+    isp::SimGpio&   gpio = static_cast<isp::SimGpio&>(isp::Gpio::getInstance().getBackend());
+
+    gpio.clear();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    isp::ISP::Error error = session.open(gSyncRetries);
+    if (error == isp::ISP::ERR_ISP_NO_ERROR)
+        error = session.run(steps);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // The span of the ISP entry sequence on the simulated lines
+    const std::vector<isp::SimGpio::Edge>& edges = gpio.getEdges();
+    double resetUS = edges.empty()? 0.0:
+                     (edges.back().timeInNS - edges.front().timeInNS) / 1.0e3;
+
+    double totalMS = (end.tv_sec - start.tv_sec) * 1.0e3 +
+                     (end.tv_nsec - start.tv_nsec) / 1.0e6;
+    unsigned baud = session.getISP().getBaudRate();
+
+    // Only the bytes sent to the target load the line; a warm pass may send none
+    uint64_t written = session.getISP().getMetrics().getCount(isp::Metrics::COUNTER_BYTES_WRITTEN);
+    double bytesPerSecond = (totalMS > 0.0)? (written * 1.0e3 / totalMS): 0.0;
+    double lineBytesPerSecond = baud / 10.0;
+    std::ostringstream json;
+
+    json << std::fixed << std::setprecision(3)
+         << "{\"image\":\""     << image.name << "\""
+         << ",\"pass\":\""      << pass << "\""
+         << ",\"result\":"      << static_cast<int>(error)
+         << ",\"bytes\":"       << bytes
+         << ",\"span\":"        << image.span
+         << ",\"baud\":"        << baud
+         << ",\"total_ms\":"    << totalMS
+         << ",\"gpio_edges\":"  << edges.size()
+         << ",\"gpio_span_us\":" << resetUS
+         << ",\"phases_ms\":"   << session.getISP().getMetrics().toJSON()
+         << ",\"counters\":"    << session.getISP().getMetrics().countersToJSON()
+         << ",\"bytes_per_s\":" << bytesPerSecond
+         << ",\"line_bytes_per_s\":" << lineBytesPerSecond
+         << ",\"line_utilization\":"
+         << ((lineBytesPerSecond > 0.0)? (bytesPerSecond / lineBytesPerSecond): 0.0)
+         << "}";
+    std::cout << json.str() << std::endl;
+    return error;
+}
+
+
+///
+/// @brief      Get the unsigned argument that follows an option.
+///
+/// @param[in]  cmdLine
+///             Reference to the command line.
+///
+/// @param[in]  pLong
+///             The long option name.
+///
+/// @param[in]  pShort
+///             The short option name.
+///
+/// @param[out] value
+///             The value of the argument; unchanged if the option is absent.
+///
+/// @return     Boolean false if the option is present without a number.
+///
+static bool getOption(isp::CmdLine& cmdLine,
+                      const char * pLong,
+                      const char * pShort,
+                      uint32_t& value)
+{
+    size_t      index = -1;
+    std::string argument;
+
+    if (cmdLine.find(pLong, index) || cmdLine.find(pShort, index))
+    {
+        if (!cmdLine.get(index + 1, argument) ||
+            argument.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+
+        value = static_cast<uint32_t>(strtoul(argument.c_str(), nullptr, 10));
+    }
+    return true;
+}
+
+
+///
+/// @brief      Application entry point.
+///
+/// @details    Run erase, program and verify of each benchmark image
+///             against an emulated target on a pseudo-terminal and print
+///             one JSON line per pass.  The cold pass starts from blank
+///             flash with the application running, so the target has to be
+///             reset into ISP mode; the warm pass finds it still there and
+///             programs the same image again.
+///
+/// @param[in]  argc    Number of command line arguments, including
+///                     the invoking program name.
+/// @param[in]  argv    List of constant c-strings for each argument,
+///                     starting with the program name itself at the
+///                     index of zero.
+///
+/// @retval     0       Success.
+/// @retval     <other> Unix-style error codes.
+///
+int main(int argc,
+         char * const argv[] )
+{
+    isp::CmdLine    cmdLine(argc, argv);
+    size_t          index = -1;
+    std::string     only;
+    uint32_t        byteTime = UINT32_MAX;
+    uint32_t        eraseTime = isp::Target::DEFAULT_ERASE_TIME;
+    uint32_t        programTime = isp::Target::DEFAULT_PROGRAM_TIME;
+    int             returnCode = 0;
+
+    if (cmdLine.find("--help", index) ||
+        cmdLine.find("-h", index) ||
+        !getOption(cmdLine, "--baud", "-b", gMaxBaud) ||
+        !getOption(cmdLine, "--byte-us", "-B", byteTime) ||
+        !getOption(cmdLine, "--erase-ms", "-E", eraseTime) ||
+        !getOption(cmdLine, "--program-us", "-C", programTime))
+    {
+        std::cerr << "ISP flash-time benchmark for LPC15xx"                     << std::endl;
+        std::cerr << ""                                                         << std::endl;
+        std::cerr << "Usage:"                                                   << std::endl;
+        std::cerr << "isp15xx-bench [OPTIONS]"                                  << std::endl;
+        std::cerr << " OPTIONS:"                                                << std::endl;
+        std::cerr << "  --image      | -i    Run only the named image"          << std::endl;
+        std::cerr << "  --baud       | -b    Highest baud rate to negotiate"    << std::endl;
+        std::cerr << "  --byte-us    | -B    Fixed time per byte, 0 for none"   << std::endl;
+        std::cerr << "  --erase-ms   | -E    Erase time per sector (100)"       << std::endl;
+        std::cerr << "  --program-us | -C    Program time per 256 bytes (1000)" << std::endl;
+        std::cerr << "  --pipeline   | -w    Send write data with its command"  << std::endl;
+        std::cerr << "  --verbose    | -v    Show the client log"               << std::endl;
+        std::cerr << "  --help       | -h    Show this help"                    << std::endl;
+        std::cerr << " Images:";
+        for (const tBenchImage& image : sImages)
+            std::cerr << " " << image.name;
+        std::cerr << std::endl;
+        exit(cmdLine.find("--help", index) || cmdLine.find("-h", index)? 0: 1);
+    }
+
+    if (cmdLine.find("--image", index) ||
+        cmdLine.find("-i", index))
+    {
+        cmdLine.get(index + 1, only);
+    }
+
+    gIsPipeline = cmdLine.find("--pipeline", index) || cmdLine.find("-w", index);
+
+    // There is no fixture, so record the reset sequence instead
+    isp::Gpio::setBackend("sim");
+
+    // Delta and CRC verify are only as good as the CRC both ends use
+    if (!checkCRC())
+        return 1;
+
+    // The report goes to stdout, so keep the client log off it
+    if (!cmdLine.find("--verbose", index) && !cmdLine.find("-v", index))
+        isp::Log::ReportingLevel() = static_cast<tLogLevel>(ERROR + 1);
+
+    for (const tBenchImage& image : sImages)
+    {
+        if (only.length() > 0 && only != image.name)
+            continue;
+
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0)
+        {
+            std::cerr << "Cannot open a pseudo-terminal: " << strerror(errno) << std::endl;
+            returnCode = 1;
+            break;
+        }
+
+        // Hold the slave open so the target survives between passes
+        std::string device = ptsname(master);
+        int slave = open(device.c_str(), O_RDWR | O_NOCTTY);
+        struct termios settings;
+
+        tcgetattr(slave, &settings);
+        cfmakeraw(&settings);
+        tcsetattr(slave, TCSANOW, &settings);
+
+        isp::Target target(master, isp::Part::getDefault());
+        std::atomic<bool> isDone(false);
+
+        if (byteTime != UINT32_MAX)
+            target.setByteTime(byteTime);
+        target.setEraseTime(eraseTime);
+        target.setProgramTime(programTime);
+
+        // The simulated RESET line boots the target as the real one would
+        isp::SimGpio& gpio = static_cast<isp::SimGpio&>(isp::Gpio::getInstance().getBackend());
+
+        gpio.setListener([&target](const isp::SimGpio::Edge& edge, unsigned values)
+        {
+            unsigned isp0 = isp::GpioBackend::mask(isp::GpioBackend::LINE_ISP0);
+
+            if ((edge.line == isp::GpioBackend::LINE_RESET) && (edge.value == gIsActiveLowReset))
+            {
+                if (values & isp0)
+                    target.startApplication();
+                else
+                    target.enterBootloader();
+            }
+        });
+        target.startApplication();
+
+        std::thread targetThread(&isp::Target::run, &target, std::cref(isDone));
+        uint32_t bytes = makeImage(image);
+
+        if (runPass(device, image, bytes, "cold",
+                    isp::Session::STEP_ERASE | isp::Session::STEP_PROGRAM |
+                    isp::Session::STEP_VERIFY) ||
+            runPass(device, image, bytes, "warm",
+                    isp::Session::STEP_PROGRAM | isp::Session::STEP_VERIFY))
+        {
+            returnCode = 1;
+        }
+
+        isDone = true;
+        targetThread.join();
+        gpio.setListener(isp::SimGpio::tListener());
+        close(slave);
+        close(master);
+    }
+
+    return returnCode;
+}
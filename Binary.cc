@@ -14,6 +14,7 @@
 #include <iostream>
 #include <iomanip>
 #include "Binary.hh"
+#include "Log.hh"
 
 using namespace std;
 
@@ -21,13 +22,12 @@ using namespace std;
 /// @brief      Binary constructor.
 ///
 isp::Binary::Binary(std::string& filename,
-                    uint8_t * pMemory,
-                    size_t memSize)
+                    FirmwareImage& image)
      : m_filename(filename),
        m_Size(0U),
        m_pBuffer(nullptr),
        m_isDirty(false),
-       m_pMemory(pMemory),
+       m_Image(image),
        m_StartAddress(0U),
        m_EndAddress(0U)
 {
@@ -47,9 +47,8 @@ isp::Binary::Binary(std::string& filename,
         }
         else if (!m_ifs.is_open())
         {
-            cerr << "Error: Cannot open file "
-                 << m_filename
-                 << endl;
+            LOG(ERROR) << "Error: Cannot open file "
+                       << m_filename;
         }
     }
 }
@@ -76,11 +75,20 @@ bool isp::Binary::parse()
     m_StartAddress = 0U;
     m_EndAddress   = m_Size - 1;
 
-    cout << "CHECKSUM is 0x" << hex << setw(8) << setfill('0')
-         << calculateChecksum(reinterpret_cast<uint32_t *>(m_pBuffer))
-         << endl;
+    if (!m_Image.write(0U, m_pBuffer, m_Size))
+        return false;
 
-    memcpy(m_pMemory, m_pBuffer, m_Size);
+    // Needed to boot into the application, when the file holds the table
+    uint8_t * pVectors = m_Image.getData(0U, 8 * sizeof(uint32_t));
+    if (pVectors)
+    {
+        uint32_t checksum = calculateChecksum(reinterpret_cast<uint32_t *>(pVectors));
+
+        LOG(INFO) << "CHECKSUM is 0x" << hex << setw(8) << setfill('0') << checksum;
+
+        // Keep the file contents in step for write
+        memcpy(m_pBuffer, pVectors, 8 * sizeof(uint32_t));
+    }
     return true;
 }
 
@@ -139,13 +147,12 @@ uint32_t isp::Binary::calculateChecksum(uint32_t * pAddress)
     checksum = 0xffffffff - checksum + 1;
     if (pAddress[7] != checksum)
     {
-        cout << "Updating checksum from 0x"
-             << hex << setw(8) << setfill('0')
-             << pAddress[7]
-             << " to 0x"
-             << hex << setw(8) << setfill('0')
-             << checksum
-             << endl;
+        LOG(INFO) << "Updating checksum from 0x"
+                  << hex << setw(8) << setfill('0')
+                  << pAddress[7]
+                  << " to 0x"
+                  << hex << setw(8) << setfill('0')
+                  << checksum;
         m_isDirty = true;
         pAddress[7] = checksum;
     }
@@ -9,6 +9,7 @@
 #define BINARY_HH
 #include <string>
 #include <fstream>
+#include "FirmwareImage.hh"
 
 // Namespace
 namespace isp {
@@ -22,11 +23,9 @@ public:
     ///
     /// @param[in]  filename    The input filename to open.
     ///
-    /// @param[in]  pMemory     The output memory block to write to.
+    /// @param[in]  image       The firmware image to write to.
     ///
-    /// @param[in]  memSize     The size of the output block in bytes.
-    ///
-    Binary(std::string& filename, uint8_t * pMemory, size_t memSize);
+    Binary(std::string& filename, FirmwareImage& image);
 
     ///
     /// @brief      Binary destructor.
@@ -126,7 +125,7 @@ private:
     size_t          m_Size;
     uint8_t *       m_pBuffer;
     bool            m_isDirty;
-    uint8_t *       m_pMemory;
+    FirmwareImage&  m_Image;
     uint32_t        m_StartAddress;
     uint32_t        m_EndAddress;
     std::ifstream   m_ifs;
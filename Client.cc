@@ -6,83 +6,174 @@
 ///
 
 //  Includes
+#include <string.h>
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include "Client.hh"
+#include "FirmwareImage.hh"
 #include "iHex.hh"
 #include "Log.hh"
+#include "Part.hh"
 #include "Serial.hh"
 #include "Utility.hh"
 
 
 // External References
 extern  bool        gIsVerbose;
-extern  bool        gIsActiveLowReset;
-extern  bool        gQuit;
-extern  uint32_t    gStartAddress;
-extern  uint32_t    gEndAddress;
-extern  uint32_t    gStartSector;
-extern  uint32_t    gEndSector;
-extern  uint8_t     gMemory[];
+extern  uint32_t    gStageSize;
+extern  bool        gIsDelta;
+extern  isp::FirmwareImage  gImage;
 
 //
-//  @brief      Test the client ISP interface.
+//  @brief      Program one flash sector from the firmware image.
 //
-isp::ISP::Error isp::eraseClient(const char * device, const unsigned syncRetries)
+//  @details    Each RAM stage of gStageSize bytes, limited to the
+//              part's largest copy, is written to the start of the ISP RAM
+//              window (the legacy 1 KB mode uses two 512-byte writes), then
+//              copied to flash with a single prepare and copy.  Stages are
+//              written from the top of the sector down.  A sector the image
+//              leaves all 0xFF is done once it is erased.
+//
+static isp::ISP::Error programSector(isp::ISP& isp,
+                                     const isp::PartInfo& part,
+                                     uint32_t sector)
 {
-    LOG(INFO) << "Entering " << __func__ << "()";
-
-    isp::Serial     serial(device);
-    isp::ISP        isp(serial, gIsActiveLowReset, gIsVerbose);
     isp::ISP::Error error = isp::ISP::ERR_ISP_NO_ERROR;
+    uint32_t stage = std::min(gStageSize, part.maxCopySize);
+    int32_t stageSize = static_cast<int32_t>(stage);
+    size_t writeSize = (stage < isp::Part::SECTOR_SIZE)? (stage / 2): stage;
+    int32_t sectorSize = static_cast<int32_t>(isp::Part::SECTOR_SIZE);
 
-    do
+    if (gImage.isErased(sector))
+        return error;
+
+    for (int32_t ram = sectorSize - stageSize; ram >= 0; ram -= stageSize)
     {
-        for (unsigned retries = syncRetries; retries > 0; --retries)
+        size_t offset = (sector * isp::Part::SECTOR_SIZE + ram);
+
+        // Now write the RAM with the data to program
+        for (size_t chunk = 0; chunk < stage; chunk += writeSize)
         {
-            // Enter ISP programming mode.
-            isp.programMode();
+            isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_RAM_WRITE);
+            std::vector<uint8_t> ramBytes(writeSize);
 
-            if (gQuit == true)
-                break;
+            gImage.read(offset + chunk, ramBytes.data(), writeSize);
 
-            // Synchronize to the target
-            if ((error = isp.synchronize()))
+            if ((error = isp.writeMemory(part.ramStart + chunk,
+                                         writeSize,
+                                         ramBytes,
+                                         isp::ISP::LONG_TIMEOUT)))
             {
-                LOG(WARNING) << "Initial synchronization failed: " << error;
-                if (retries)
-                {
-                    LOG(INFO) << "Retrying synchronization...";
-                    continue;
-                }
-            }
-            else
-            {
-                break;
+                LOG(ERROR) << "Error in writing memory: " << error;
+                return error;
             }
         }
 
-        if (error != isp::ISP::ERR_ISP_NO_ERROR)
+        // Prepare sectors for writing
+        isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_COPY);
+        if ((error = isp.prepareSectors(sector, sector, isp::ISP::MEDIUM_TIMEOUT)))
         {
-            LOG(ERROR) << "Synchronization failed -- ABORTING";
-            break;
+            LOG(ERROR) << "Error preparing sectors: " << error;
+            return error;
+        }
+
+        // Copy to flash
+        uint32_t flashAddress = (sector * isp::Part::SECTOR_SIZE + ram);
+        LOG(INFO) << "Writing flash at 0x"
+                  << std::setw(8) << std::setfill('0') << std::hex << flashAddress;
+
+        if ((error = isp.copyToFlash(flashAddress,
+                                     part.ramStart,
+                                     stage,
+                                     isp::ISP::LONG_TIMEOUT)))
+        {
+            LOG(ERROR) << "Error on copy to flash: " << error;
+            return error;
         }
+    }
+    return error;
+}
+
+
+//
+//  @brief      Read back a range of flash and compare it with the image.
+//
+//  @details    Reports the first address that differs from the firmware
+//              image as a compare error.
+//
+static isp::ISP::Error compareRange(isp::ISP& isp, uint32_t address, size_t size)
+{
+    isp::ISP::Error error = isp::ISP::ERR_ISP_NO_ERROR;
+    uint8_t ramBytes[ isp::Part::SECTOR_SIZE ];
+    uint8_t imageBytes[ isp::Part::SECTOR_SIZE ];
+
+    // A whole sector per command; the reply is framed by length, so the
+    // read runs at line rate whatever the contents
+    for (size_t offset = 0; offset < size; offset += sizeof(ramBytes))
+    {
+        uint32_t base = address + offset;
+        size_t count = std::min(sizeof(ramBytes), size - offset);
+        size_t bytesRead = 0U;
 
-        // Setup the baud rate
-        if ((error = isp.setBaudRate(115200)))
+        if ((error = isp.readMemory(base, count, ramBytes, bytesRead)))
         {
-            LOG(ERROR) << "Error in setting baud rate: " << error;
+            LOG(ERROR) << "Error in reading memory: " << error;
             break;
         }
 
-        // Target chip ID
-        uint32_t chip = 0U;
-        if ((error = isp.queryId(chip)))
+        if (gIsVerbose)
+            isp::Utility::hexDump(ramBytes, bytesRead, base);
+
+        if (bytesRead < count)
         {
-            LOG(ERROR) << "Error in querying chip ID: " << error;
+            LOG(ERROR) << "Short read at address 0x"
+                       << std::setw(8) << std::setfill('0') << std::hex << base;
+            error = isp::ISP::ERR_ISP_COMPARE_ERROR;
             break;
         }
 
+        gImage.read(base, imageBytes, count);
+        if (memcmp(imageBytes, ramBytes, count) == 0)
+            continue;
+
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            if (imageBytes[ ii ] != ramBytes[ ii ])
+            {
+                LOG(ERROR) << "Mismatch at address 0x"
+                           << std::setw(8) << std::setfill('0') << std::hex << (base + ii);
+                return isp::ISP::ERR_ISP_COMPARE_ERROR;
+            }
+        }
+    }
+    return error;
+}
+
+
+//
+//  @brief      Calculate the CRC-32 of a range of the firmware image.
+//
+static uint32_t imageCRC(uint32_t address, size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+
+    gImage.read(address, bytes.data(), size);
+    return isp::Utility::crc32(bytes.data(), size);
+}
+
+
+//
+//  @brief      Erase the chip.
+//
+isp::ISP::Error isp::eraseClient(isp::ISP& isp, const isp::PartInfo& part)
+{
+    LOG(INFO) << "Entering " << __func__ << "()";
+
+    isp::ISP::Error error = isp::ISP::ERR_ISP_NO_ERROR;
+
+    do
+    {
         // Unlock flash
         if ((error = isp.unlockFlash()))
         {
@@ -91,31 +182,24 @@ isp::ISP::Error isp::eraseClient(const char * device, const unsigned syncRetries
         }
 
         // Blank check
-        std::vector<bool> sectorMap
-        {
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false
-        };
+        std::vector<bool> sectorMap(part.sectorCount, false);
 
         LOG(INFO) << "Blank check...";
-        for (unsigned ii = 0; ii < 64; ++ii)
+        for (unsigned ii = 0; ii < part.sectorCount; ++ii)
         {
+            isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_BLANK_CHECK);
+
             error = isp.blankCheckSector(ii, sectorMap);
             LOG(INFO) << "Sector " << ii << " is " << (sectorMap[ii]? "blank": "NOT-BLANK");
         }
 
         LOG(INFO) << "Erasing flash...";
-        gEndSector = 63;
 
-        // Now start to program....
-        for (int32_t sector = gEndSector; sector >= 0; --sector)
+        // Now start to erase....
+        for (int32_t sector = part.sectorCount - 1; sector >= 0; --sector)
         {
+            isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_ERASE);
+
             do
             {
                 // Unlock flash
@@ -147,202 +231,152 @@ isp::ISP::Error isp::eraseClient(const char * device, const unsigned syncRetries
         }
     } while (false);
 
-    LOG(INFO) << "Leaving eraseClient: errorCode is " << error;
-
-    isp.applicationMode();
+    LOG(INFO) << "Leaving " << __func__ << "(): errorCode is " << error;
     return error;
 }
 
 
 //
-//  @brief      Test the client ISP interface.
+//  @brief      Program the target through the ISP client interface.
 //
-isp::ISP::Error isp::programClient(const char * device, const unsigned syncRetries)
+isp::ISP::Error isp::programClient(isp::ISP& isp, const isp::PartInfo& part)
 {
-    isp::Serial     serial(device);
-    isp::ISP        isp(serial, gIsActiveLowReset, gIsVerbose);
     isp::ISP::Error error = isp::ISP::ERR_ISP_NO_ERROR;
 
     LOG(INFO) << "Entering " << __func__ << "()";
 
     do
     {
-        for (unsigned retries = syncRetries; retries > 0; --retries)
+        uint32_t startSector = gImage.getStartSector();
+        uint32_t endSector = gImage.getEndSector();
+
+        if (endSector >= part.sectorCount)
         {
-            // Enter ISP programming mode.
-            isp.programMode();
+            LOG(ERROR) << "Image ends in sector " << std::dec << endSector
+                       << " but " << part.name << " has "
+                       << part.sectorCount << " sectors";
+            error = isp::ISP::ERR_ISP_INVALID_SECTOR;
+            break;
+        }
 
-            if (gQuit == true)
-                break;
+        // Blank check
+        std::vector<bool> sectorMap(part.sectorCount, false);
 
-            // Synchronize to the target
-            if ((error = isp.synchronize()))
+        // Find the sectors whose contents already match the image
+        std::vector<bool> matchMap(sectorMap.size(), false);
+        if (gIsDelta)
+        {
+            LOG(INFO) << "Comparing sector checksums...";
+            unsigned matches = 0U;
+
+            for (uint32_t sector = startSector; sector <= endSector; ++sector)
             {
-                LOG(WARNING) << "Initial synchronization failed: " << error;
-                if (retries)
-                {
-                    LOG(INFO) << "Retrying synchronization...";
+                if (!gImage.isPopulated(sector))
                     continue;
+
+                isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_COMPARE);
+                uint32_t address = sector * isp::Part::SECTOR_SIZE;
+                uint32_t crc = 0U;
+
+                if ((error = isp.queryCRC(address, isp::Part::SECTOR_SIZE, crc)))
+                {
+                    LOG(WARNING) << "Error in querying CRC: " << error
+                                 << " -- programming all sectors";
+                    matchMap.assign(matchMap.size(), false);
+                    matches = 0U;
+                    error = isp::ISP::ERR_ISP_NO_ERROR;
+                    break;
                 }
+
+                matchMap[ sector ] = (crc == gImage.getCRC(sector));
+                if (matchMap[ sector ])
+                    ++matches;
             }
-            else
-            {
-                break;
-            }
+            LOG(INFO) << std::dec << matches << " of " << gImage.getPopulatedCount()
+                      << " sectors already match the image";
         }
 
-        if (error != isp::ISP::ERR_ISP_NO_ERROR)
+        LOG(INFO) << "Blank check...";
+        for (unsigned ii = startSector; ii <= endSector; ++ii)
         {
-            LOG(ERROR) << "Synchronization failed -- ABORTING";
-            break;
-        }
+            if (matchMap[ ii ] || !gImage.isPopulated(ii))
+                continue;
 
-        // Setup the baud rate
-        if ((error = isp.setBaudRate(115200)))
-        {
-            LOG(ERROR) << "Error in setting baud rate: " << error;
-            break;
+            isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_BLANK_CHECK);
+            error = isp.blankCheckSector(ii, sectorMap);
+            LOG(INFO) << "Sector " << ii << " is " << (sectorMap[ii]? "blank": "NOT-BLANK");
         }
 
-        // Target chip ID
-        uint32_t chip = 0U;
-        if ((error = isp.queryId(chip)))
+        LOG(INFO) << "Programming flash...";
+
+        // Disable echo so the binary RAM data is not echoed back; it
+        // stays off for the whole programming pass.
+        if ((error = isp.echo(false, isp::ISP::MEDIUM_TIMEOUT)))
         {
-            LOG(ERROR) << "Error in querying chip ID: " << error;
+            LOG(ERROR) << "Error in setting echo: " << error;
             break;
         }
 
-        // Blank check
-        std::vector<bool> sectorMap
+        // Unlock flash; it stays unlocked until the next reset.
+        if ((error = isp.unlockFlash(isp::ISP::SHORT_TIMEOUT)))
         {
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false,
-             false, false, false, false, false, false, false, false
-        };
-
-        LOG(INFO) << "Blank check...";
-        for (unsigned ii = gStartSector; ii <= gEndSector; ++ii)
-        {
-            error = isp.blankCheckSector(ii, sectorMap);
-            LOG(INFO) << "Sector " << ii << " is " << (sectorMap[ii]? "blank": "NOT-BLANK");
+            LOG(ERROR) << "Error in unlocking flash: " << error;
+            break;
         }
 
-        LOG(INFO) << "Programming flash...";
-
         // Now start to program...
-        for (int32_t sector = gEndSector; sector >= 0; --sector)
+        for (int32_t sector = endSector; sector >= static_cast<int32_t>(startSector); --sector)
         {
-            do
+            // Skip the sectors the image leaves alone or that already hold it
+            if (matchMap[ sector ] || !gImage.isPopulated(sector))
+                continue;
+
+            // If the sector is not blank, erase it.
+            if (!sectorMap[ sector ])
             {
-                // Unlock flash
-                if ((error = isp.unlockFlash(isp::ISP::SHORT_TIMEOUT)))
+                isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_ERASE);
+
+                // Prepare sectors for writing
+                if ((error = isp.prepareSectors(sector, sector, isp::ISP::MEDIUM_TIMEOUT)))
                 {
-                    LOG(ERROR) << "Error in unlocking flash: " << error;
+                    LOG(ERROR) << "Error preparing sectors: " << error;
                     break;
                 }
 
-                // If the sector is not blank, erase it.
-                if (!sectorMap[ sector ])
+                // Erase flash
+                if ((error = isp.eraseSectors(sector, sector, isp::ISP::LONG_TIMEOUT)))
                 {
-                    // Prepare sectors for writing
-                    if ((error = isp.prepareSectors(sector, sector, isp::ISP::MEDIUM_TIMEOUT)))
-                    {
-                        LOG(ERROR) << "Error preparing sectors: " << error;
-                        break;
-                    }
-
-                    // Erase flash
-                    if ((error = isp.eraseSectors(sector, sector, isp::ISP::LONG_TIMEOUT)))
-                    {
-                        LOG(ERROR) << "Error erasing sectors: " << error;
-                        break;
-                    }
+                    LOG(ERROR) << "Error erasing sectors: " << error;
+                    break;
                 }
+            }
 
-                // Write the memory to flash
-                for (int32_t ram = FLASH_SECTOR_SIZE - RAM_SECTOR_SIZE; ram >= 0; ram -= RAM_SECTOR_SIZE )
-                {
-                    // Disable echo
-                    if ((error = isp.echo(false, isp::ISP::MEDIUM_TIMEOUT)))
-                    {
-                        LOG(ERROR) << "Error in setting echo: " << error;
-                        break;
-                    }
-
-                    size_t offset = (sector * FLASH_SECTOR_SIZE + ram);
-                    {
-                        std::vector<uint8_t> ramBytes(&gMemory[offset],
-                                                      &gMemory[offset + (RAM_SECTOR_SIZE / 2)]);
-
-                        // Now write the RAM with the data to program
-                        if ((error = isp.writeMemory(RAM_PROGRAM_ADDRESS,
-                                                     (RAM_SECTOR_SIZE / 2),
-                                                     ramBytes,
-                                                     isp::ISP::LONG_TIMEOUT)))
-                        {
-                            LOG(ERROR) << "Error in writing memory: " << error;
-                            break;
-                        }
-                    }
-
-                    offset += (RAM_SECTOR_SIZE / 2);
-                    {
-                        std::vector<uint8_t> ramBytes(&gMemory[offset],
-                                                      &gMemory[offset + (RAM_SECTOR_SIZE / 2)]);
-
-                        // Now write the RAM with the data to program
-                        if ((error = isp.writeMemory(RAM_PROGRAM_ADDRESS + (RAM_SECTOR_SIZE / 2),
-                                                     (RAM_SECTOR_SIZE / 2),
-                                                     ramBytes,
-                                                     isp::ISP::LONG_TIMEOUT)))
-                        {
-                            LOG(ERROR) << "Error in writing memory: " << error;
-                            break;
-                        }
-                    }
-
-                    // Enable echo
-                    if ((error = isp.echo(true, isp::ISP::MEDIUM_TIMEOUT)))
-                    {
-                        LOG(ERROR) << "Error in setting echo: " << error;
-                        break;
-                    }
-
-                    // Unlock flash
-                    if ((error = isp.unlockFlash(isp::ISP::MEDIUM_TIMEOUT)))
-                    {
-                        LOG(ERROR) << "Error in unlocking flash: " << error;
-                        break;
-                    }
-
-                    // Prepare sectors for writing
-                    if ((error = isp.prepareSectors(sector, sector, isp::ISP::MEDIUM_TIMEOUT)))
-                    {
-                        LOG(ERROR) << "Error preparing sectors: " << error;
-                        break;
-                    }
+            // Write the memory to flash.  If the link fails part way,
+            // drop to a slower baud rate and redo the whole sector.
+            error = programSector(isp, part, sector);
+            while (isp::ISP::isLinkError(error) &&
+                   (isp.fallbackBaudRate() == isp::ISP::ERR_ISP_NO_ERROR))
+            {
+                LOG(WARNING) << "Retrying sector " << std::dec << sector
+                             << " at " << isp.getBaudRate() << " baud";
+                isp.getMetrics().count(isp::Metrics::COUNTER_RETRIES);
 
-                    // Copy to flash
-                    uint32_t flashAddress = (sector * FLASH_SECTOR_SIZE + ram);
-                    LOG(INFO) << "Writing flash at 0x"
-                              << std::setw(8) << std::setfill('0') << std::hex << flashAddress;
+                if (!(error = isp.prepareSectors(sector, sector, isp::ISP::MEDIUM_TIMEOUT)) &&
+                    !(error = isp.eraseSectors(sector, sector, isp::ISP::LONG_TIMEOUT)))
+                    error = programSector(isp, part, sector);
+            }
 
-                    if ((error = isp.copyToFlash(flashAddress,
-                                                 RAM_PROGRAM_ADDRESS,
-                                                 RAM_SECTOR_SIZE,
-                                                  isp::ISP::LONG_TIMEOUT )))
-                    {
-                        LOG(ERROR) << "Error on copy to flash: " << error;
-                        break;
-                    }
-                }
+            if (error)
+                break;
+        }
 
-            } while (false);
+        // Restore echo
+        isp::ISP::Error echoError = isp.echo(true, isp::ISP::MEDIUM_TIMEOUT);
+        if (echoError)
+        {
+            LOG(ERROR) << "Error in setting echo: " << echoError;
+            if (error == isp::ISP::ERR_ISP_NO_ERROR)
+                error = echoError;
         }
 
         if (error == isp::ISP::ERR_ISP_NO_ERROR)
@@ -351,155 +385,87 @@ isp::ISP::Error isp::programClient(const char * device, const unsigned syncRetri
     } while (false);
 
     LOG(INFO) << "Leaving " << __func__ << "(): errorCode is " << error;
-    isp.applicationMode();
     return error;
 }
 
 
 //
-//  @brief      Test the client ISP interface.
+//  @brief      Examine target memory through the ISP client interface.
 //
-isp::ISP::Error isp::examineClient(const char * device, const unsigned syncRetries)
+isp::ISP::Error isp::examineClient(isp::ISP& isp, const isp::PartInfo& part)
 {
     LOG(INFO) << "Entering " << __func__ << "()";
 
-    isp::Serial     serial(device);
-    isp::ISP        isp(serial, gIsActiveLowReset, gIsVerbose);
     isp::ISP::Error error = isp::ISP::ERR_ISP_NO_ERROR;
+    isp::Metrics::Timer timer(isp.getMetrics(), isp::Metrics::PHASE_VERIFY);
 
     do
     {
-        for (unsigned retries = syncRetries; retries > 0; --retries)
-        {
-            // Enter ISP programming mode.
-            isp.programMode();
-
-            if (gQuit == true)
-                break;
+        uint32_t startSector = gImage.getStartSector();
+        uint32_t endSector = gImage.getEndSector();
 
-            // Synchronize to the target
-            if ((error = isp.synchronize()))
-            {
-                LOG(WARNING) << "Initial synchronization failed: " << error;
-                if (retries)
-                {
-                    LOG(INFO) << "Retrying synchronization...";
-                    continue;
-                }
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        if (error != isp::ISP::ERR_ISP_NO_ERROR)
+        if (endSector >= part.sectorCount)
         {
-            LOG(ERROR) << "Synchronization failed -- ABORTING";
+            LOG(ERROR) << "Image ends in sector " << std::dec << endSector
+                       << " but " << part.name << " has "
+                       << part.sectorCount << " sectors";
+            error = isp::ISP::ERR_ISP_INVALID_SECTOR;
             break;
         }
 
-        // Setup the baud rate
-        if ((error = isp.setBaudRate(115200)))
-        {
-            LOG(ERROR) << "Error in setting baud rate: " << error;
-            break;
-        }
+        LOG(INFO) << "Verifying...";
+
+        // Word-aligned image range for the 'S' command
+        uint32_t imageStart = (gImage.getStartAddress() & ~3U);
+        uint32_t imageEnd   = ((gImage.getEndAddress() + 4U) & ~3U);
+        uint32_t crc = 0U;
 
-        // Target chip ID
-        uint32_t chip = 0U;
-        if ((error = isp.queryId(chip)))
+        // A single CRC over each run of populated sectors settles the
+        // common case; sectors the image leaves alone are not checked
+        for (uint32_t first = startSector; first <= endSector && !error; ++first)
         {
-            LOG(ERROR) << "Error in querying chip ID: " << error;
-            break;
-        }
+            if (!gImage.isPopulated(first))
+                continue;
 
-        uint8_t * memBlock = new uint8_t[ (gEndSector - gStartSector + 1) * FLASH_SECTOR_SIZE ];
-        if (!memBlock )
-            break;
+            uint32_t last = first;
+            while ((last < endSector) && gImage.isPopulated(last + 1U))
+                ++last;
 
-        LOG(INFO) << "Verifying...";
+            uint32_t runStart = std::max<uint32_t>(first * isp::Part::SECTOR_SIZE, imageStart);
+            uint32_t runEnd   = std::min<uint32_t>((last + 1U) * isp::Part::SECTOR_SIZE, imageEnd);
 
-        // Now start to read the memory...
-        for (uint32_t sector = gStartSector; sector <= gEndSector; ++sector)
-        {
-            do
+            if (!isp.queryCRC(runStart, runEnd - runStart, crc) &&
+                (crc == imageCRC(runStart, runEnd - runStart)))
             {
-                // Read memory...
-                for (uint32_t ram = 0U; ram < FLASH_SECTOR_SIZE; ram += RAM_SECTOR_SIZE )
-                {
-                    size_t offset = (sector * FLASH_SECTOR_SIZE + ram);
-                    {
-                        std::vector<uint8_t> ramBytes;
-
-                        // Now write the RAM with the data to program
-                        if ((error = isp.readMemory(offset, (RAM_SECTOR_SIZE / 2), ramBytes)))
-                        {
-                            LOG(ERROR) << "Error in reading memory: " << error;
-                            break;
-                        }
-                        else
-                        {
-                            for (unsigned ii = 0; ii < ramBytes.size(); ++ii)
-                                memBlock[ offset + ii ] = ramBytes.data()[ ii ];
-
-                            if (gIsVerbose)
-                                isp::Utility::hexDump(ramBytes.data(), ramBytes.size(), offset);
-                        }
-                    }
+                first = last;
+                continue;
+            }
 
-                    offset += (RAM_SECTOR_SIZE / 2);
-                    {
-                        std::vector<uint8_t> ramBytes;
-
-                        // Now write the RAM with the data to program
-                        if ((error = isp.readMemory(offset, (RAM_SECTOR_SIZE / 2), ramBytes)))
-                        {
-                            LOG(ERROR) << "Error in writing memory: " << error;
-                            break;
-                        }
-                        else
-                        {
-                            for (unsigned ii = 0; ii < ramBytes.size(); ++ii)
-                                memBlock[ offset + ii ] = ramBytes.data()[ ii ];
-
-                            if (gIsVerbose)
-                                isp::Utility::hexDump(ramBytes.data(), ramBytes.size(), offset);
-                        }
-                    }
-                }
+            // Otherwise, find the sectors that differ and read those back
+            for (uint32_t sector = first; sector <= last; ++sector)
+            {
+                uint32_t start = std::max<uint32_t>(sector * isp::Part::SECTOR_SIZE, imageStart);
+                uint32_t end   = std::min<uint32_t>((sector + 1) * isp::Part::SECTOR_SIZE, imageEnd);
 
-                if (error != isp::ISP::ERR_ISP_NO_ERROR)
-                    break;
+                uint32_t expected = (end - start == isp::Part::SECTOR_SIZE)?
+                                    gImage.getCRC(sector): imageCRC(start, end - start);
 
-            } while (false);
-        }
+                if (!isp.queryCRC(start, end - start, crc) && (crc == expected))
+                    continue;
 
-        for (unsigned ii = gStartAddress; ii < gEndAddress; ++ii)
-        {
-            if (gMemory[ ii ] != memBlock[ ii ])
-            {
-                LOG(ERROR) << "Mismatch at address 0x"
-                           << std::setw(8) << std::setfill('0') << std::hex << ii;
-                error = isp::ISP::ERR_ISP_COMPARE_ERROR;
-                break;
+                LOG(INFO) << "Sector " << std::dec << sector << " differs; reading back...";
+                if ((error = compareRange(isp, start, end - start)))
+                    break;
             }
+            first = last;
         }
 
         if (error == isp::ISP::ERR_ISP_NO_ERROR)
             LOG(INFO) << "Verify success!";
 
-        if (memBlock)
-        {
-            delete[] memBlock;
-            memBlock = nullptr;
-        }
-
     } while (false);
 
     LOG(INFO) << "Leaving " << __func__ << "(): errorCode is " << error;
-
-    isp.applicationMode();
     return error;
 }
 
@@ -11,11 +11,10 @@
 #include <stdint.h>
 #include <string.h>
 #include "ISP.hh"
+#include "Part.hh"
 
 // Definitions
-#define FLASH_SECTOR_SIZE     (4096)
 #define RAM_SECTOR_SIZE       (1024)
-#define RAM_PROGRAM_ADDRESS   (0x02001000)
 
 
 //  Namespace
@@ -24,44 +23,44 @@ namespace isp {
 ///
 /// @brief      Erase the chip.
 ///
-/// @param[in]  device
-///             The string for the serial device to open.
+/// @param[in]  isp
+///             Reference to the synchronized ISP connection.
 ///
-/// @param[in]  syncRetries
-///             The number of retries to establish synchronization.
+/// @param[in]  part
+///             Reference to the geometry of the target part.
 ///
 /// @return     The error code for the operation where zero is success and
 ///             any other value is an error.
 ///
-extern ISP::Error eraseClient(const char * device, unsigned syncRetries);
+extern ISP::Error eraseClient(ISP& isp, const PartInfo& part);
 
 ///
 /// @brief      Program the target through the ISP client interface.
 ///
-/// @param[in]  device
-///             The string for the serial device to open.
+/// @param[in]  isp
+///             Reference to the synchronized ISP connection.
 ///
-/// @param[in]  syncRetries
-///             The number of retries to establish synchronization.
+/// @param[in]  part
+///             Reference to the geometry of the target part.
 ///
 /// @return     The error code for the operation where zero is success and
 ///             any other value is an error.
 ///
-extern ISP::Error programClient(const char * device, unsigned syncRetries);
+extern ISP::Error programClient(ISP& isp, const PartInfo& part);
 
 ///
 /// @brief      Examine target memory through the ISP client interface.
 ///
-/// @param[in]  device
-///             The string for the serial device to open.
+/// @param[in]  isp
+///             Reference to the synchronized ISP connection.
 ///
-/// @param[in]  syncRetries
-///             The number of retries to establish synchronization.
+/// @param[in]  part
+///             Reference to the geometry of the target part.
 ///
 /// @return     The error code for the operation where zero is success and
 ///             any other value is an error.
 ///
-extern ISP::Error examineClient(const char * device, unsigned syncRetries);
+extern ISP::Error examineClient(ISP& isp, const PartInfo& part);
 
 } // namespace
 #endif
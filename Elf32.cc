@@ -5,10 +5,14 @@
 /// @date   20 Dec 2014
 /// @author Don McNeill dmcneill@me.com
 ///
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 #include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -23,37 +27,14 @@ using namespace std;
 /// @brief      Elf32 constructor.
 ///
 isp::Elf32::Elf32(std::string& filename,
-                  uint8_t * pMemory,
-                  size_t memSize)
+                  FirmwareImage& image)
      : m_filename(filename),
        m_Size(0U),
        m_pBuffer(nullptr),
-       m_isDirty(false),
-       m_pMemory(pMemory),
+       m_Image(image),
        m_StartAddress(0U),
        m_EndAddress(0U)
-{
-    if (filename.size())
-    {
-        // Open the file
-        m_ifs.open(m_filename, ios::binary);
-
-        if (m_ifs.is_open() && m_ifs.good())
-        {
-            // get length of file:
-            m_ifs.seekg(0, ios::end);
-            m_Size = m_ifs.tellg();
-            m_ifs.seekg(0, ios::beg);
-
-            m_pBuffer = new uint8_t[ m_Size ];
-        }
-        else if (!m_ifs.is_open())
-        {
-            LOG(ERROR) << "Error: Cannot open file "
-                         << m_filename;
-        }
-    }
-}
+{}
 
 
 ///
@@ -62,156 +43,247 @@ isp::Elf32::Elf32(std::string& filename,
 isp::Elf32::~Elf32()
 {
     if (m_pBuffer != nullptr)
-        delete[] m_pBuffer;
-
-    if (m_ifs.is_open())
-        m_ifs.close();
+        munmap(const_cast<uint8_t *>(m_pBuffer), m_Size);
 }
 
 
 ///
-/// @brief      Parse the ELF32 header.
+/// @brief      Parse the ELF32 file and load it into the image.
 ///
 bool isp::Elf32::parse(bool isDebug)
 {
-    Elf32_Ehdr *    p2Header = (Elf32_Ehdr *) m_pBuffer;
-    SecMap          sectionMap;
-    int             i;
+    const Elf32_Ehdr * p2Header = reinterpret_cast<const Elf32_Ehdr *>(m_pBuffer);
+    bool               isLoaded = false;
 
-    if (p2Header->e_ident[4] == 0 ||
-        p2Header->e_ident[5] == 0)
+    if (m_pBuffer == nullptr || m_Size < sizeof(Elf32_Ehdr) ||
+        memcmp(p2Header->e_ident, ELFMAG, SELFMAG) != 0 ||
+        p2Header->e_ident[EI_CLASS] != ELFCLASS32 ||
+        p2Header->e_ident[EI_DATA] != ELFDATA2LSB)
+    {
+        LOG(ERROR) << "'" << m_filename << "' is not a 32-bit little-endian ELF file";
         return false;
+    }
 
     if (isDebug)
         isp::Elf32::elfHeader(p2Header);
 
     //  Program Header Section
-    Elf32_Phdr * p2Program = (Elf32_Phdr *) (m_pBuffer + p2Header->e_phoff);
-    if (isDebug)
-        isp::Elf32::program(p2Program);
+    if (p2Header->e_phnum &&
+        ((p2Header->e_phentsize < sizeof(Elf32_Phdr)) ||
+         !isInFile(p2Header->e_phoff, static_cast<uint64_t>(p2Header->e_phnum) * p2Header->e_phentsize)))
+    {
+        LOG(ERROR) << "Program headers are outside '" << m_filename << "'";
+        return false;
+    }
 
     //  Section Header Section
-    Elf32_Shdr * p2Section = (Elf32_Shdr *) (m_pBuffer +
-                             p2Header->e_shoff);
-    Elf32_Shdr * p2StrTab  = (Elf32_Shdr *) (m_pBuffer +
-                             p2Header->e_shoff + (p2Header->e_shstrndx *
-                             p2Header->e_shentsize));
-    char * p2Strings = ((char *) m_pBuffer + p2StrTab->sh_offset);
-
-    // Generate the map of sections we're interested in
-    for (i = 0; i < p2Header->e_shnum; i++)
+    if (p2Header->e_shnum &&
+        ((p2Header->e_shentsize < sizeof(Elf32_Shdr)) ||
+         (p2Header->e_shstrndx >= p2Header->e_shnum) ||
+         !isInFile(p2Header->e_shoff, static_cast<uint64_t>(p2Header->e_shnum) * p2Header->e_shentsize)))
     {
-        if ((i != p2Header->e_shstrndx) && (p2Section->sh_type != 0))
+        LOG(ERROR) << "Section headers are outside '" << m_filename << "'";
+        return false;
+    }
+
+    const uint8_t * p2Programs = m_pBuffer + p2Header->e_phoff;
+    const uint8_t * p2Sections = m_pBuffer + p2Header->e_shoff;
+    const char *    p2Strings  = "";
+    uint32_t        stringSize = 1U;
+
+    if (p2Header->e_shnum)
+    {
+        const Elf32_Shdr * p2StrTab = reinterpret_cast<const Elf32_Shdr *>(
+                                p2Sections + p2Header->e_shstrndx * p2Header->e_shentsize);
+
+        if (isInFile(p2StrTab->sh_offset, p2StrTab->sh_size) && p2StrTab->sh_size)
+        {
+            p2Strings  = reinterpret_cast<const char *>(m_pBuffer + p2StrTab->sh_offset);
+            stringSize = p2StrTab->sh_size;
+        }
+    }
+
+    m_StartAddress = UINT32_MAX;
+    m_EndAddress   = 0U;
+    m_Sections.clear();
+
+    // Every allocated section with contents, named by the string table
+    for (unsigned ii = 0; ii < p2Header->e_shnum; ++ii)
+    {
+        const Elf32_Shdr * p2Section = reinterpret_cast<const Elf32_Shdr *>(
+                                p2Sections + ii * p2Header->e_shentsize);
+
+        if ((ii == p2Header->e_shstrndx) || (p2Section->sh_type == SHT_NULL))
+            continue;
+
+        bool isNamed = (p2Section->sh_name < stringSize) &&
+                       memchr(p2Strings + p2Section->sh_name, '\0',
+                              stringSize - p2Section->sh_name);
+        const char * name = isNamed? (p2Strings + p2Section->sh_name): "";
+
+        if (isDebug && isNamed)
+            isp::Elf32::section(p2Section, p2Strings);
+
+        if (!p2Section->sh_size || !(p2Section->sh_flags & SHF_ALLOC) ||
+            (p2Section->sh_type == SHT_NOBITS))
+            continue;
+
+        if (!isInFile(p2Section->sh_offset, p2Section->sh_size))
+        {
+            LOG(ERROR) << "Section " << name << " is outside '" << m_filename << "'";
+            return false;
+        }
+
+        // The load address comes from the segment holding the section
+        uint32_t address = p2Section->sh_addr;
+
+        for (unsigned jj = 0; jj < p2Header->e_phnum; ++jj)
         {
-            if (isDebug)
-                isp::Elf32::section(p2Section, p2Strings);
+            const Elf32_Phdr * p2Program = reinterpret_cast<const Elf32_Phdr *>(
+                                    p2Programs + jj * p2Header->e_phentsize);
 
-            if (p2Section->sh_size && (p2Section->sh_flags & SHF_ALLOC))
+            if ((p2Program->p_type == PT_LOAD) &&
+                (p2Section->sh_offset >= p2Program->p_offset) &&
+                (p2Section->sh_offset - p2Program->p_offset < p2Program->p_filesz))
             {
-                if (!strncmp(&p2Strings[p2Section->sh_name], ".text", 6) ||
-                    !strncmp(&p2Strings[p2Section->sh_name], ".data", 6) ||
-                    !strncmp(&p2Strings[p2Section->sh_name], ".ARM.extab", 11) ||
-                    !strncmp(&p2Strings[p2Section->sh_name], ".ARM.exidx", 11))
-                {
-                    Section sec(&p2Strings[p2Section->sh_name],
-                                p2Section->sh_size,
-                                p2Section->sh_addr,
-                                p2Section->sh_addralign,
-                                m_pBuffer + p2Section->sh_offset);
-                    sectionMap.insert(std::pair<std::string,Section>(sec.getName(), sec));
-                }
-            } 
+                address = p2Program->p_paddr + (p2Section->sh_offset - p2Program->p_offset);
+                break;
+            }
         }
-        p2Section = (Elf32_Shdr *) ((uint8_t *) p2Section + p2Header->e_shentsize);
+
+        m_Sections.push_back(Section(name,
+                                     p2Section->sh_size,
+                                     address,
+                                     p2Section->sh_addralign,
+                                     m_pBuffer + p2Section->sh_offset));
     }
 
-    orderSection(sectionMap,      ".text",  true);
-    orderSection(sectionMap, ".ARM.extab", false);
-    orderSection(sectionMap, ".ARM.exidx", false);
-    orderSection(sectionMap,      ".data", false);
-    return true;
-}
+    // Load each segment that has file contents at its physical address
+    for (unsigned ii = 0; ii < p2Header->e_phnum; ++ii)
+    {
+        const Elf32_Phdr * p2Program = reinterpret_cast<const Elf32_Phdr *>(
+                                p2Programs + ii * p2Header->e_phentsize);
 
+        if (isDebug)
+            isp::Elf32::program(p2Program);
 
-///
-/// @brief      Place the named section in the memory at a given
-///             order.
-void isp::Elf32::orderSection(SecMap& sectionMap,
-                              const char * sectionName,
-                              bool isFirst)
-{
-    for (SecMap::iterator it = sectionMap.begin(); it != sectionMap.end(); ++it)
-    {
-        std::string name = it->first;
+        if ((p2Program->p_type != PT_LOAD) || !p2Program->p_filesz)
+            continue;
 
-        if (sectionName == name)
+        if (!isInFile(p2Program->p_offset, p2Program->p_filesz))
+        {
+            LOG(ERROR) << "Segment " << ii << " is outside '" << m_filename << "'";
+            return false;
+        }
+
+        if (!load("LOAD", p2Program->p_paddr, m_pBuffer + p2Program->p_offset, p2Program->p_filesz))
+            return false;
+        isLoaded = true;
+    }
+
+    // Without program headers the sections are all there is
+    if (!isLoaded)
+    {
+        for (const Section& sec : m_Sections)
         {
-            Section sec = it->second;
-            uint32_t nextAddress = sec.getStartAddress();
-
-            if (isFirst)
-                m_StartAddress = sec.getStartAddress();
-
-            if (name == ".data")
-                nextAddress = m_EndAddress + 1;
-
-            memcpy(m_pMemory + nextAddress,
-                   sec.getData(),
-                   sec.getSize());
-
-            // Needed to boot into the application
-            if (isFirst)
-                calculateChecksum(reinterpret_cast<uint32_t *>(m_pMemory + nextAddress));
-                
-            if (m_EndAddress < nextAddress + sec.getSize() - 1)
-                m_EndAddress = nextAddress + sec.getSize() - 1;
-
-            LOG(INFO) << setw(12) << setfill(' ')
-                      << sec.getName()
-                      << "  0x" << hex << setw(8) << setfill('0')
-                      << nextAddress
-                      << " --> "
-                      << "0x" << hex << setw(8) << setfill('0')
-                      << m_EndAddress;
+            if (!load(sec.getName(), sec.getStartAddress(), sec.getData(), sec.getSize()))
+                return false;
+            isLoaded = true;
         }
     }
+
+    if (!isLoaded)
+    {
+        LOG(ERROR) << "Nothing to load in '" << m_filename << "'";
+        m_StartAddress = 0U;
+        return false;
+    }
+
+    // Needed to boot into the application
+    uint8_t * pVectors = m_Image.getData(m_StartAddress, 8 * sizeof(uint32_t));
+    if (pVectors)
+        calculateChecksum(reinterpret_cast<uint32_t *>(pVectors));
+    return true;
 }
 
 
 ///
-/// @brief      Read the ELF32 file into memory.
+/// @brief      Copy a range from the mapped file into the image.
 ///
-bool isp::Elf32::read()
+bool isp::Elf32::load(const char * name, uint32_t address, const uint8_t * pData, size_t size)
 {
-    if (m_ifs.is_open() && m_ifs.good() && m_pBuffer && m_Size)
+    if (!m_Image.write(address, pData, size))
     {
-        m_ifs.read(reinterpret_cast<char *>(m_pBuffer), m_Size);
-        return true;
+        LOG(ERROR) << name << " at 0x" << hex << address
+                   << " is outside the address space";
+        return false;
     }
-    return false;
+
+    if (m_StartAddress > address)
+        m_StartAddress = address;
+
+    if (m_EndAddress < address + size - 1)
+        m_EndAddress = address + size - 1;
+
+    LOG(INFO) << setw(12) << setfill(' ')
+              << name
+              << "  0x" << hex << setw(8) << setfill('0')
+              << address
+              << " --> "
+              << "0x" << hex << setw(8) << setfill('0')
+              << (address + size - 1);
+    return true;
 }
 
 
 ///
-/// @brief      Write the memory block to the ELF32 file.
+/// @brief      Map the ELF32 file into memory.
 ///
-bool isp::Elf32::write()
+bool isp::Elf32::read()
 {
-    bool result = false;
-
-    // Open the file
-    m_ofs.open(m_filename, ios::binary);
+    bool        result = false;
+    int         fileDes = -1;
+    struct stat info;
 
-    // Write the content
-    if (m_ofs.is_open() && m_ofs.good())
+    do
     {
-        m_ofs.write(reinterpret_cast<char *>(m_pBuffer), m_Size);
-        result = true;
-    }
+        if (m_pBuffer != nullptr)
+        {
+            result = true;
+            break;
+        }
+
+        if ((fileDes = open(m_filename.c_str(), O_RDONLY | O_CLOEXEC)) < 0 ||
+            fstat(fileDes, &info) < 0)
+        {
+            LOG(ERROR) << "Error: Cannot open file "
+                       << m_filename;
+            break;
+        }
+
+        if (info.st_size == 0)
+        {
+            LOG(ERROR) << "'" << m_filename << "' is empty";
+            break;
+        }
+
+        // Sections and segments are viewed in place, never copied
+        void * pMap = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fileDes, 0);
+        if (pMap == MAP_FAILED)
+        {
+            LOG(ERROR) << "Map failed for '" << m_filename << "' -- "
+                       << errno << " " << strerror(errno);
+            break;
+        }
+
+        m_pBuffer = static_cast<const uint8_t *>(pMap);
+        m_Size    = info.st_size;
+        result    = true;
+
+    } while (false);
 
-    // Close the file
-    if (m_ofs.is_open())
-        m_ofs.close();
+    if (fileDes >= 0)
+        close(fileDes);
     return result;
 }
 
@@ -611,7 +683,7 @@ std::string& isp::Elf32::sectionFlagsToString(std::string& str, int flags)
 ///
 /// @brief      Display the ELF file header content.
 ///
-void isp::Elf32::elfHeader(Elf32_Ehdr * p2Header)
+void isp::Elf32::elfHeader(const Elf32_Ehdr * p2Header)
 {
     std::string str;
 
@@ -667,7 +739,7 @@ void isp::Elf32::elfHeader(Elf32_Ehdr * p2Header)
 ///
 /// @brief      Display the ELF file program content.
 ///
-void isp::Elf32::program(Elf32_Phdr * p2Program)
+void isp::Elf32::program(const Elf32_Phdr * p2Program)
 {
     std::string str;
 
@@ -698,7 +770,7 @@ void isp::Elf32::program(Elf32_Phdr * p2Program)
 ///
 /// @brief      Display the ELF section header content.
 ///
-void isp::Elf32::section(Elf32_Shdr * p2Section, char * p2Strings)
+void isp::Elf32::section(const Elf32_Shdr * p2Section, const char * p2Strings)
 {
     std::string typeStr;
     std::string str;
@@ -759,7 +831,6 @@ uint32_t isp::Elf32::calculateChecksum(uint32_t * pAddress)
                   << " to 0x"
                   << hex << setw(8) << setfill('0')
                   << checksum;
-        m_isDirty = true;
         pAddress[7] = checksum;
     }
     return checksum;
@@ -8,46 +8,44 @@
 #ifndef ELF32_HH
 #define ELF32_HH
 #include <fstream>
-#include <map>
 #include <string>
 #include <vector>
 #include "elf.h"
+#include "FirmwareImage.hh"
 
 // Namespace
 namespace isp {
 
-typedef std::vector<uint8_t> ByteVec;
-
+///
+/// @brief      Read-only view of one section in the mapped file.
+///
 class Section
 {
 public:
     ///
     /// @brief      Section constructor.
     ///
-    /// @param[in]  name        The section name.
+    /// @param[in]  name        The section name, in the mapped file.
     ///
     /// @param[in]  size        Size of the section in bytes.
     ///
-    /// @param[in]  startAddr   Start address of the section on chip.
+    /// @param[in]  startAddr   Load address of the section on chip.
     ///
     /// @param[in]  alignment   The start address alignment.
     ///
-    /// @param[in]  pMemory     Pointer to byte memory to copy data from.
+    /// @param[in]  pData       The section data, in the mapped file.
     ///
     Section(const char * name,
             size_t size,
             uint32_t startAddr,
             uint32_t alignment,
-            uint8_t * pMemory)
-        : m_Name(name),
+            const uint8_t * pData)
+        : m_pName(name),
           m_StartAddress(startAddr),
           m_Alignment(alignment),
-          m_Size(size)
-    {
-        m_Vector.resize(size);
-
-        ::memcpy(m_Vector.data(), pMemory, size);
-    }
+          m_Size(size),
+          m_pData(pData)
+    {}
 
     ///
     /// @brief      Section destructor.
@@ -60,48 +58,51 @@ public:
     ///
     /// @return     The constant character string for the name.
     ///
-    const char * getName() { return m_Name.c_str(); }
+    const char * getName() const { return m_pName; }
 
     ///
     /// @brief      Get the section's size in bytes.
     ///
     /// @return     The size of the data for the section in bytes.
     ///
-    size_t getSize() { return m_Size; }
+    size_t getSize() const { return m_Size; }
 
     ///
-    /// @brief      Get the start address for the section.
+    /// @brief      Get the load address for the section.
+    ///
+    /// @details    This is where the section is stored in flash, which
+    ///             for initialised data is not where it runs.
     ///
     /// @return     The start address as a 32-bit unsigned int.
     ///
-    uint32_t getStartAddress() { return m_StartAddress; }
+    uint32_t getStartAddress() const { return m_StartAddress; }
 
     ///
     /// @brief      Get the alignment for the section.
     ///
     /// @return     The byte-alignment setting for the section.
     ///
-    uint32_t getAlignment() { return m_Alignment; }
+    uint32_t getAlignment() const { return m_Alignment; }
 
     ///
     /// @brief      Get the data block for the section.
     ///
-    /// @return     The constant pointer to the start of the section data.
+    /// @return     The constant pointer to the start of the section data;
+    ///             valid while the Elf32 object that made it exists.
     ///
-    uint8_t const * getData() { return m_Vector.data(); }
+    uint8_t const * getData() const { return m_pData; }
 
 private:
     //  Data members
-    std::string m_Name;
-    uint32_t    m_StartAddress;
-    uint32_t    m_Alignment;
-    size_t      m_Size;
-    ByteVec     m_Vector;
-    
+    const char *    m_pName;
+    uint32_t        m_StartAddress;
+    uint32_t        m_Alignment;
+    size_t          m_Size;
+    const uint8_t * m_pData;
 };
 
 
-typedef std::map<std::string, Section> SecMap;
+typedef std::vector<Section> SecList;
 
 class Elf32
 {
@@ -111,11 +112,9 @@ public:
     ///
     /// @param[in]  filename    The input filename to open.
     ///
-    /// @param[in]  pMemory     The output memory block to write to.
-    ///
-    /// @param[in]  memSize     The size of the output block in bytes.
+    /// @param[in]  image       The firmware image to write to.
     ///
-    Elf32(std::string& filename, uint8_t * pMemory, size_t memSize);
+    Elf32(std::string& filename, FirmwareImage& image);
 
     ///
     /// @brief      Elf32 destructor.
@@ -123,7 +122,13 @@ public:
     virtual ~Elf32();
 
     ///
-    /// @brief      Parse the ELF32 header.
+    /// @brief      Parse the ELF32 file and load it into the image.
+    ///
+    /// @details    Each PT_LOAD segment is copied straight from the mapped
+    ///             file to its physical address, so initialised data lands
+    ///             where the startup code copies it from.  A file without
+    ///             program headers has its allocated sections loaded at
+    ///             their addresses instead, whatever they are named.
     ///
     /// @param[in]  isDebug     Boolean flag for verbosity.
     ///
@@ -132,47 +137,40 @@ public:
     bool parse(bool isDebug);
 
     ///
-    /// @brief      See if the ELF file needs to be written.
-    ///
-    /// @return     Boolean true on dirty (needs write) and false if
-    ///             no write needed.
-    ///
-    bool isDirty() { return m_isDirty; }
-
-    ///
-    /// @brief      Read the ELF32 file into memory.
+    /// @brief      Map the ELF32 file into memory.
     ///
     /// @return     Boolean true on sucess and false on error.
     ///
     bool read();
 
     ///
-    /// @brief      Write the memory block to the ELF32 file.
+    /// @brief      Get the lowest address loaded.
     ///
-    /// @return     Boolean true on sucess and false on error.
-    ///
-    bool write();
-
-    ///
-    /// @brief      Get the start address for the .text section.
-    ///
-    /// @details    Get the start address for the .text section so
-    ///             that the starting block and size can be calculated.
+    /// @details    Get the lowest address loaded so that the starting
+    ///             block and size can be calculated.
     ///
     /// @return     The start address as an unsigned integer.
     ///
     uint32_t getStartAddress() { return m_StartAddress; }
 
     ///
-    /// @brief      Get the end address for the .text section.
+    /// @brief      Get the highest address loaded.
     ///
-    /// @details    Get the end address for the .text section so
-    ///             that the ending block and size can be calculated.
+    /// @details    Get the highest address loaded so that the ending
+    ///             block and size can be calculated.
     ///
     /// @return     The end address as an unsigned integer.
     ///
     uint32_t getEndAddress() { return m_EndAddress; }
 
+    ///
+    /// @brief      Get the allocated sections that have file contents.
+    ///
+    /// @return     The views of the sections, in file order, each at its
+    ///             load address.
+    ///
+    const SecList& getSections() const { return m_Sections; }
+
     ///
     /// @brief      Align an address value.
     ///
@@ -315,14 +313,14 @@ public:
     ///
     /// @param[in]  p2Header    The ELF32 file header staring address in memory.
     ///
-    static void elfHeader(Elf32_Ehdr * p2Header);
+    static void elfHeader(const Elf32_Ehdr * p2Header);
 
     ///
     /// @brief      Display the ELF file program content.
     ///
     /// @param[in]  p2Header    The ELF32 program header staring address in memory.
     ///
-    static void program(Elf32_Phdr * p2Program);
+    static void program(const Elf32_Phdr * p2Program);
 
     ///
     /// @brief      Display the ELF section header content.
@@ -331,7 +329,7 @@ public:
     ///
     /// @param[in]  p2Strings   Pointer to the name string table in memory.
     ///
-    static void section(Elf32_Shdr * p2Section, char * p2Strings);
+    static void section(const Elf32_Shdr * p2Section, const char * p2Strings);
 
 private:
     ///
@@ -373,29 +371,42 @@ private:
     uint32_t calculateChecksum(uint32_t * pAddress);
 
     ///
-    /// @brief      Place the named section in the memory at a given
-    ///             order.
+    /// @brief      Determine if a range lies within the mapped file.
+    ///
+    /// @param[in]  offset      The file offset of the range.
+    ///
+    /// @param[in]  size        The size of the range in bytes.
+    ///
+    /// @return     Boolean true if every byte is in the file.
+    ///
+    bool isInFile(uint32_t offset, uint64_t size) const
+    {
+        return (offset <= m_Size) && (size <= m_Size - offset);
+    }
+
+    ///
+    /// @brief      Copy a range from the mapped file into the image.
+    ///
+    /// @param[in]  name        The name to log for the range.
+    ///
+    /// @param[in]  address     The load address.
     ///
-    /// @param[in]  sectionMap  The section map reference to use.
+    /// @param[in]  pData       The data, in the mapped file.
     ///
-    /// @param[in]  sectionName The key string for the section to use.
+    /// @param[in]  size        The size in bytes.
     ///
-    /// @param[in]  isFirst     Flag to denote the first section.
+    /// @return     Boolean false if the range is outside the address space.
     ///
-    void orderSection(SecMap& sectionMap,
-                      const char * sectionName,
-                      bool isFirst);
+    bool load(const char * name, uint32_t address, const uint8_t * pData, size_t size);
 
     // Data members
     std::string     m_filename;
     size_t          m_Size;
-    uint8_t *       m_pBuffer;
-    bool            m_isDirty;
-    uint8_t *       m_pMemory;
+    const uint8_t * m_pBuffer;
+    FirmwareImage&  m_Image;
     uint32_t        m_StartAddress;
     uint32_t        m_EndAddress;
-    std::ifstream   m_ifs;
-    std::ofstream   m_ofs;
+    SecList         m_Sections;
 }; // class
 
 } // namespace
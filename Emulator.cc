@@ -0,0 +1,193 @@
+///
+/// @file   Emulator.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+
+//  Includes
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <atomic>
+#include <iostream>
+#include "CmdLine.hh"
+#include "Log.hh"
+#include "Part.hh"
+#include "Signal.hh"
+#include "Target.hh"
+#include "Utility.hh"
+
+
+//  Global variables
+std::atomic<bool> gQuit(false);
+
+
+///
+/// @brief      Handler for SIGINT and SIGTERM.
+///
+/// @param[in]  event
+///             The signal number.
+///
+void termHandler(int event)
+{
+    gQuit = true;
+}
+
+
+///
+/// @brief      Get the unsigned argument that follows an option.
+///
+/// @param[in]  cmdLine
+///             Reference to the command line.
+///
+/// @param[in]  pLong
+///             The long option name.
+///
+/// @param[in]  pShort
+///             The short option name.
+///
+/// @param[out] value
+///             The value of the argument; unchanged if the option is absent.
+///
+/// @return     Boolean false if the option is present without a number.
+///
+static bool getOption(isp::CmdLine& cmdLine,
+                      const char * pLong,
+                      const char * pShort,
+                      uint32_t& value)
+{
+    size_t      index = -1;
+    std::string argument;
+
+    if (cmdLine.find(pLong, index) || cmdLine.find(pShort, index))
+    {
+        if (!cmdLine.get(index + 1, argument) ||
+            argument.find_first_not_of("0123456789abcdefxABCDEF") != std::string::npos)
+            return false;
+
+        value = static_cast<uint32_t>(strtoul(argument.c_str(), nullptr, 0));
+    }
+    return true;
+}
+
+
+///
+/// @brief      Application entry point.
+///
+/// @details    Open a pseudo-terminal, print the name of its slave side and
+///             emulate an LPC15xx bootloader on it until interrupted.
+///
+/// @param[in]  argc    Number of command line arguments, including
+///                     the invoking program name.
+/// @param[in]  argv    List of constant c-strings for each argument,
+///                     starting with the program name itself at the
+///                     index of zero.
+///
+/// @retval     0       Success.
+/// @retval     <other> Unix-style error codes.
+///
+int main(int argc,
+         char * const argv[] )
+{
+    isp::CmdLine    cmdLine(argc, argv);
+    size_t          index = -1;
+    std::string     link;
+    uint32_t        partId = isp::Part::getDefault().id;
+    uint32_t        byteTime = UINT32_MAX;
+    uint32_t        eraseTime = isp::Target::DEFAULT_ERASE_TIME;
+    uint32_t        programTime = isp::Target::DEFAULT_PROGRAM_TIME;
+    int             returnCode = 0;
+
+    if (cmdLine.find("--help", index) ||
+        cmdLine.find("-h", index) ||
+        !getOption(cmdLine, "--part", "-P", partId) ||
+        !getOption(cmdLine, "--byte-us", "-B", byteTime) ||
+        !getOption(cmdLine, "--erase-ms", "-E", eraseTime) ||
+        !getOption(cmdLine, "--program-us", "-C", programTime))
+    {
+        std::cerr << "LPC15xx ISP target emulator"                              << std::endl;
+        std::cerr << ""                                                         << std::endl;
+        std::cerr << "Usage:"                                                   << std::endl;
+        std::cerr << "isp15xx-emu [OPTIONS]"                                    << std::endl;
+        std::cerr << " OPTIONS:"                                                << std::endl;
+        std::cerr << "  --part       | -P    Part ID to emulate (0x1549)"       << std::endl;
+        std::cerr << "  --byte-us    | -B    Fixed time per byte, 0 for none"   << std::endl;
+        std::cerr << "                       (default: ten bits at the baud)"   << std::endl;
+        std::cerr << "  --erase-ms   | -E    Erase time per sector (100)"       << std::endl;
+        std::cerr << "  --program-us | -C    Program time per 256 bytes (1000)" << std::endl;
+        std::cerr << "  --link       | -L    Symlink to create for the pty"     << std::endl;
+        std::cerr << "  --verbose    | -v    Trace every command"               << std::endl;
+        std::cerr << "  --help       | -h    Show this help"                    << std::endl;
+        exit(cmdLine.find("--help", index) || cmdLine.find("-h", index)? 0: 1);
+    }
+
+    if (cmdLine.find("--link", index) ||
+        cmdLine.find("-L", index))
+    {
+        cmdLine.get(index + 1, link);
+    }
+
+    do
+    {
+        const isp::PartInfo * pPart = isp::Part::find(partId);
+        if (!pPart)
+        {
+            LOG(ERROR) << "Unknown part 0x" << std::hex << partId;
+            returnCode = 1;
+            break;
+        }
+
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0)
+        {
+            LOG(ERROR) << "Cannot open a pseudo-terminal: " << strerror(errno);
+            returnCode = 1;
+            break;
+        }
+
+        std::string slaveName = ptsname(master);
+
+        // Hold the slave open so the master does not see a hang-up
+        // between client runs, and keep the line raw until a client
+        // sets it up.
+        int slave = open(slaveName.c_str(), O_RDWR | O_NOCTTY);
+        struct termios settings;
+
+        tcgetattr(slave, &settings);
+        cfmakeraw(&settings);
+        tcsetattr(slave, TCSANOW, &settings);
+
+        if (link.length() > 0)
+        {
+            unlink(link.c_str());
+            if (symlink(slaveName.c_str(), link.c_str()) < 0)
+                LOG(WARNING) << "Cannot link " << link << ": " << strerror(errno);
+        }
+
+        isp::Signal sigInt(SIGINT, termHandler);
+        isp::Signal sigTerm(SIGTERM, termHandler);
+        isp::Target target(master, *pPart);
+
+        if (byteTime != UINT32_MAX)
+            target.setByteTime(byteTime);
+        target.setEraseTime(eraseTime);
+        target.setProgramTime(programTime);
+        target.setVerbose(cmdLine.find("--verbose", index) || cmdLine.find("-v", index));
+
+        std::cout << slaveName << std::endl;
+        LOG(INFO) << "Emulating " << pPart->name << " on " << slaveName;
+
+        target.run(gQuit);
+
+        if (link.length() > 0)
+            unlink(link.c_str());
+        close(slave);
+        close(master);
+    } while (false);
+
+    return returnCode;
+}
@@ -0,0 +1,371 @@
+///
+/// @file   FirmwareImage.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <string.h>
+#include <algorithm>
+#include "FirmwareImage.hh"
+#include "Part.hh"
+#include "Utility.hh"
+
+
+//  Definitions
+//  One past the highest address
+#define ADDRESS_LIMIT   (0x100000000ULL)
+
+
+//
+//  @brief      Explicit constructor for the FirmwareImage class.
+//
+isp::FirmwareImage::FirmwareImage(uint8_t fill)
+        : mFill(fill),
+          mIsIndexed(false)
+{}
+
+
+//
+//  @brief      Remove every extent.
+//
+void isp::FirmwareImage::clear()
+{
+    mExtents.clear();
+    mSectorFlags.clear();
+    mSectorCRCs.clear();
+    mIsIndexed = false;
+}
+
+
+//
+//  @brief      Make room for bytes at an address.
+//
+uint8_t * isp::FirmwareImage::reserve(uint32_t address, size_t size)
+{
+    uint64_t end = static_cast<uint64_t>(address) + size;
+
+    if ((size == 0U) || (end > ADDRESS_LIMIT))
+        return nullptr;
+
+    mSectorFlags.clear();
+    mSectorCRCs.clear();
+    mIsIndexed = false;
+
+    // Records mostly carry on from the one before
+    if (!mExtents.empty() && (mExtents.back().getEnd() == address))
+    {
+        std::vector<uint8_t>& data = mExtents.back().data;
+        size_t offset = data.size();
+
+        data.resize(offset + size, mFill);
+        return &data[ offset ];
+    }
+
+    // The extents the range overlaps or touches
+    size_t first = (address? find(address - 1U): 0U);
+    size_t last = first;
+
+    while ((last < mExtents.size()) && (mExtents[ last ].address <= end))
+        ++last;
+
+    if (first == last)
+    {
+        Extent extent = { address, std::vector<uint8_t>(size, mFill) };
+
+        mExtents.insert(mExtents.begin() + first, std::move(extent));
+        return mExtents[ first ].data.data();
+    }
+
+    Extent& merged = mExtents[ first ];
+
+    if ((last == first + 1U) && (merged.address <= address) && (merged.getEnd() >= end))
+        return &merged.data[ address - merged.address ];
+
+    // Grow the first extent over the range and the others
+    if (address < merged.address)
+    {
+        merged.data.insert(merged.data.begin(), merged.address - address, mFill);
+        merged.address = address;
+    }
+
+    uint64_t stop = std::max(end, mExtents[ last - 1U ].getEnd());
+
+    for (size_t ii = first + 1U; ii < last; ++ii)
+    {
+        const Extent& next = mExtents[ ii ];
+
+        merged.data.resize(next.address - merged.address, mFill);
+        merged.data.insert(merged.data.end(), next.data.begin(), next.data.end());
+    }
+    merged.data.resize(stop - merged.address, mFill);
+    mExtents.erase(mExtents.begin() + first + 1U, mExtents.begin() + last);
+
+    return &mExtents[ first ].data[ address - mExtents[ first ].address ];
+}
+
+
+//
+//  @brief      Copy bytes into the image.
+//
+bool isp::FirmwareImage::write(uint32_t address, const uint8_t * pData, size_t size)
+{
+    uint8_t * pOut = reserve(address, size);
+
+    if (pOut == nullptr)
+        return false;
+
+    memcpy(pOut, pData, size);
+    return true;
+}
+
+
+//
+//  @brief      Copy bytes out of the image.
+//
+void isp::FirmwareImage::read(uint32_t address, uint8_t * pBuffer, size_t size) const
+{
+    uint64_t end = static_cast<uint64_t>(address) + size;
+
+    memset(pBuffer, mFill, size);
+    for (size_t ii = find(address); ii < mExtents.size(); ++ii)
+    {
+        const Extent& extent = mExtents[ ii ];
+
+        if (extent.address >= end)
+            break;
+
+        uint64_t from = std::max<uint64_t>(address, extent.address);
+        uint64_t to   = std::min(end, extent.getEnd());
+
+        memcpy(pBuffer + (from - address), &extent.data[ from - extent.address ], to - from);
+    }
+}
+
+
+//
+//  @brief      Get the bytes of a range held in a single extent.
+//
+uint8_t * isp::FirmwareImage::getData(uint32_t address, size_t size)
+{
+    size_t ii = find(address);
+
+    if ((ii == mExtents.size()) ||
+        (mExtents[ ii ].address > address) ||
+        (mExtents[ ii ].getEnd() < static_cast<uint64_t>(address) + size))
+        return nullptr;
+
+    return &mExtents[ ii ].data[ address - mExtents[ ii ].address ];
+}
+
+
+//
+//  @brief      Flag every sector up to the last populated one.
+//
+void isp::FirmwareImage::index()
+{
+    mSectorFlags.clear();
+    mSectorCRCs.clear();
+    mIsIndexed = false;
+
+    if (mExtents.empty())
+        return;
+
+    uint32_t count = getEndSector() + 1U;
+
+    mSectorFlags.reserve(count);
+    mSectorCRCs.reserve(count);
+    for (uint32_t sector = 0U; sector < count; ++sector)
+    {
+        uint8_t flags = flagSector(sector);
+
+        // Untouched sectors are never written, so their CRC is not needed
+        mSectorFlags.push_back(flags);
+        mSectorCRCs.push_back((flags & FLAG_POPULATED)? crcSector(sector): 0U);
+    }
+    mIsIndexed = true;
+}
+
+
+//
+//  @brief      Take the sector flags and CRCs from elsewhere.
+//
+bool isp::FirmwareImage::setIndex(const uint8_t * pFlags, const uint32_t * pCRCs, uint32_t count)
+{
+    if (mExtents.empty() || (count != getEndSector() + 1U))
+        return false;
+
+    mSectorFlags.assign(pFlags, pFlags + count);
+    mSectorCRCs.assign(pCRCs, pCRCs + count);
+    mIsIndexed = true;
+    return true;
+}
+
+
+//
+//  @brief      Get the number of bytes held.
+//
+size_t isp::FirmwareImage::getSize() const
+{
+    size_t size = 0U;
+
+    for (const Extent& extent : mExtents)
+        size += extent.data.size();
+    return size;
+}
+
+
+//
+//  @brief      Get the lowest address held.
+//
+uint32_t isp::FirmwareImage::getStartAddress() const
+{
+    return mExtents.empty()? 0U: mExtents.front().address;
+}
+
+
+//
+//  @brief      Get the highest address held.
+//
+uint32_t isp::FirmwareImage::getEndAddress() const
+{
+    return mExtents.empty()? 0U: static_cast<uint32_t>(mExtents.back().getEnd() - 1U);
+}
+
+
+//
+//  @brief      Get the sector of the lowest address held.
+//
+uint32_t isp::FirmwareImage::getStartSector() const
+{
+    return getStartAddress() / isp::Part::SECTOR_SIZE;
+}
+
+
+//
+//  @brief      Get the sector of the highest address held.
+//
+uint32_t isp::FirmwareImage::getEndSector() const
+{
+    return getEndAddress() / isp::Part::SECTOR_SIZE;
+}
+
+
+//
+//  @brief      Get the number of populated sectors.
+//
+uint32_t isp::FirmwareImage::getPopulatedCount() const
+{
+    uint32_t count = 0U;
+
+    if (mExtents.empty())
+        return count;
+
+    for (uint32_t sector = getStartSector(); sector <= getEndSector(); ++sector)
+    {
+        if (isPopulated(sector))
+            ++count;
+    }
+    return count;
+}
+
+
+//
+//  @brief      Determine if any extent reaches into a sector.
+//
+bool isp::FirmwareImage::isPopulated(uint32_t sector) const
+{
+    return (getFlags(sector) & FLAG_POPULATED) != 0;
+}
+
+
+//
+//  @brief      Determine if every byte of a sector reads as 0xFF.
+//
+bool isp::FirmwareImage::isErased(uint32_t sector) const
+{
+    return (getFlags(sector) & FLAG_ERASED) != 0;
+}
+
+
+//
+//  @brief      Work out the flags of one sector from the extents.
+//
+uint8_t isp::FirmwareImage::flagSector(uint32_t sector) const
+{
+    uint64_t start = static_cast<uint64_t>(sector) * isp::Part::SECTOR_SIZE;
+    uint64_t end   = start + isp::Part::SECTOR_SIZE;
+    uint64_t held  = 0U;
+    bool     isErased = true;
+
+    for (size_t ii = find(start); ii < mExtents.size() && isErased; ++ii)
+    {
+        const Extent& extent = mExtents[ ii ];
+
+        if (extent.address >= end)
+            break;
+
+        uint64_t from = std::max<uint64_t>(start, extent.address);
+        uint64_t to   = std::min(end, extent.getEnd());
+        const uint8_t * p = &extent.data[ from - extent.address ];
+
+        held += to - from;
+        isErased = std::all_of(p, p + (to - from),
+                               [](uint8_t byte) { return byte == ERASED_VALUE; });
+    }
+
+    // The gaps read as the fill value; the scan stops at the first byte
+    // that is not erased, so held may fall short only when that is known
+    if ((held < isp::Part::SECTOR_SIZE) && (mFill != ERASED_VALUE))
+        isErased = false;
+
+    return (held? FLAG_POPULATED: 0U) | (isErased? FLAG_ERASED: 0U);
+}
+
+
+//
+//  @brief      Work out the CRC-32 of one sector from the extents.
+//
+uint32_t isp::FirmwareImage::crcSector(uint32_t sector) const
+{
+    uint8_t bytes[ isp::Part::SECTOR_SIZE ];
+
+    read(sector * isp::Part::SECTOR_SIZE, bytes, sizeof(bytes));
+    return isp::Utility::crc32(bytes, sizeof(bytes));
+}
+
+
+//
+//  @brief      Get the CRC-32 of one sector.
+//
+uint32_t isp::FirmwareImage::getCRC(uint32_t sector) const
+{
+    if (mIsIndexed && (sector < mSectorCRCs.size()) && (mSectorFlags[ sector ] & FLAG_POPULATED))
+        return mSectorCRCs[ sector ];
+    return crcSector(sector);
+}
+
+
+//
+//  @brief      Get the flags of one sector.
+//
+uint8_t isp::FirmwareImage::getFlags(uint32_t sector) const
+{
+    if (mIsIndexed && (sector < mSectorFlags.size()))
+        return mSectorFlags[ sector ];
+    return flagSector(sector);
+}
+
+
+//
+//  @brief      Find the first extent ending past an address.
+//
+size_t isp::FirmwareImage::find(uint64_t address) const
+{
+    auto it = std::upper_bound(mExtents.begin(), mExtents.end(), address,
+                               [](uint64_t value, const Extent& extent)
+                               { return value < extent.getEnd(); });
+
+    return it - mExtents.begin();
+}
@@ -0,0 +1,315 @@
+///
+/// @file   FirmwareImage.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef FIRMWAREIMAGE_HH_
+#define FIRMWAREIMAGE_HH_
+
+//  Includes
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Sparse memory image of the firmware to program.
+///
+/// @details    Only the bytes a loader writes are stored, as sorted extents
+///             that never overlap or touch; the gaps read as the fill value.
+///             Each flash sector is flagged as populated when any extent
+///             reaches into it, and as erased when every byte in it reads
+///             as 0xFF.  Sectors that are not populated are left alone on
+///             the target.  The CRC-32 of each sector, as the bootloader
+///             works it out, is kept with the flags.
+///
+class FirmwareImage
+{
+public:
+    static const uint8_t ERASED_VALUE   = 0xFF;
+    static const uint8_t FLAG_POPULATED = 0x01;   ///< An extent reaches into the sector
+    static const uint8_t FLAG_ERASED    = 0x02;   ///< Every byte reads as 0xFF
+
+    ///
+    /// @brief      A run of bytes at consecutive addresses.
+    ///
+    struct Extent
+    {
+        uint32_t                address;    ///< Address of the first byte
+        std::vector<uint8_t>    data;       ///< The bytes
+
+        ///
+        /// @brief      Get the address just past the extent.
+        ///
+        /// @return     The end address, which may be 4 GB.
+        ///
+        uint64_t getEnd() const { return static_cast<uint64_t>(address) + data.size(); }
+    };
+
+    ///
+    /// @brief      Explicit constructor for the FirmwareImage class.
+    ///
+    /// @param[in]  fill
+    ///             The value read from addresses no loader wrote.
+    ///
+    explicit FirmwareImage(uint8_t fill = ERASED_VALUE);
+
+    ///
+    /// @brief      Default destructor for the FirmwareImage class.
+    ///
+    ~FirmwareImage() {}
+
+    ///
+    /// @brief      Remove every extent.
+    ///
+    void clear();
+
+    ///
+    /// @brief      Make room for bytes at an address.
+    ///
+    /// @details    Extents the range overlaps or touches are merged with it,
+    ///             and bytes not already in the image start as the fill
+    ///             value.  Loaders decode straight into the room returned.
+    ///
+    /// @param[in]  address
+    ///             The address of the first byte.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    /// @return     Pointer to the byte at the address, valid until the
+    ///             image next changes, or nullptr if the size is zero or
+    ///             the range passes the end of the address space.
+    ///
+    uint8_t * reserve(uint32_t address, size_t size);
+
+    ///
+    /// @brief      Copy bytes into the image.
+    ///
+    /// @param[in]  address
+    ///             The address of the first byte.
+    ///
+    /// @param[in]  pData
+    ///             The bytes.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    /// @return     Boolean false if the range cannot be reserved.
+    ///
+    bool write(uint32_t address, const uint8_t * pData, size_t size);
+
+    ///
+    /// @brief      Copy bytes out of the image.
+    ///
+    /// @details    Addresses no loader wrote read as the fill value.
+    ///
+    /// @param[in]  address
+    ///             The address of the first byte.
+    ///
+    /// @param[out] pBuffer
+    ///             The buffer for the bytes.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    void read(uint32_t address, uint8_t * pBuffer, size_t size) const;
+
+    ///
+    /// @brief      Get the bytes of a range held in a single extent.
+    ///
+    /// @param[in]  address
+    ///             The address of the first byte.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    /// @return     Pointer to the byte at the address, valid until the
+    ///             image next changes, or nullptr if any byte of the range
+    ///             is not in the image.
+    ///
+    uint8_t * getData(uint32_t address, size_t size);
+
+    ///
+    /// @brief      Flag every sector up to the last populated one.
+    ///
+    /// @details    Call once loading is done; the flags and CRCs are
+    ///             dropped by any change and worked out sector by sector
+    ///             until the next call.  An indexed image is safe to read
+    ///             from many threads.
+    ///
+    void index();
+
+    ///
+    /// @brief      Take the sector flags and CRCs from elsewhere.
+    ///
+    /// @details    For an image restored from a cache, in place of index.
+    ///
+    /// @param[in]  pFlags
+    ///             The FLAG_ bits of each sector from zero.
+    ///
+    /// @param[in]  pCRCs
+    ///             The CRC-32 of each sector from zero.
+    ///
+    /// @param[in]  count
+    ///             The number of sectors; one past the end sector.
+    ///
+    /// @return     Boolean false if the count does not fit the image.
+    ///
+    bool setIndex(const uint8_t * pFlags, const uint32_t * pCRCs, uint32_t count);
+
+    ///
+    /// @brief      Determine if the image holds no bytes.
+    ///
+    /// @return     Boolean true if there are no extents.
+    ///
+    bool isEmpty() const { return mExtents.empty(); }
+
+    ///
+    /// @brief      Get the extents.
+    ///
+    /// @return     Reference to the extents, sorted by address.
+    ///
+    const std::vector<Extent>& getExtents() const { return mExtents; }
+
+    ///
+    /// @brief      Get the fill value.
+    ///
+    /// @return     The value read from addresses no loader wrote.
+    ///
+    uint8_t getFill() const { return mFill; }
+
+    ///
+    /// @brief      Get the number of bytes held.
+    ///
+    /// @return     The total size of the extents in bytes.
+    ///
+    size_t getSize() const;
+
+    ///
+    /// @brief      Get the lowest address held.
+    ///
+    /// @return     The start address, or zero for an empty image.
+    ///
+    uint32_t getStartAddress() const;
+
+    ///
+    /// @brief      Get the highest address held.
+    ///
+    /// @return     The end address, or zero for an empty image.
+    ///
+    uint32_t getEndAddress() const;
+
+    ///
+    /// @brief      Get the sector of the lowest address held.
+    ///
+    /// @return     The start sector.
+    ///
+    uint32_t getStartSector() const;
+
+    ///
+    /// @brief      Get the sector of the highest address held.
+    ///
+    /// @return     The end sector.
+    ///
+    uint32_t getEndSector() const;
+
+    ///
+    /// @brief      Get the number of populated sectors.
+    ///
+    /// @return     The number of sectors any extent reaches into.
+    ///
+    uint32_t getPopulatedCount() const;
+
+    ///
+    /// @brief      Determine if any extent reaches into a sector.
+    ///
+    /// @param[in]  sector
+    ///             The flash sector.
+    ///
+    /// @return     Boolean true if the sector is to be programmed.
+    ///
+    bool isPopulated(uint32_t sector) const;
+
+    ///
+    /// @brief      Determine if every byte of a sector reads as 0xFF.
+    ///
+    /// @param[in]  sector
+    ///             The flash sector.
+    ///
+    /// @return     Boolean true if erasing alone leaves the sector as the
+    ///             image has it.
+    ///
+    bool isErased(uint32_t sector) const;
+
+    ///
+    /// @brief      Get the flags of one sector.
+    ///
+    /// @param[in]  sector
+    ///             The flash sector.
+    ///
+    /// @return     The FLAG_ bits for the sector.
+    ///
+    uint8_t getFlags(uint32_t sector) const;
+
+    ///
+    /// @brief      Get the CRC-32 of one sector.
+    ///
+    /// @details    The gaps count as the fill value, as they are written.
+    ///
+    /// @param[in]  sector
+    ///             The flash sector.
+    ///
+    /// @return     The CRC-32 of the whole sector.
+    ///
+    uint32_t getCRC(uint32_t sector) const;
+
+private:
+    FirmwareImage(const FirmwareImage& ref) = delete;
+    FirmwareImage& operator = (const FirmwareImage& ref) = delete;
+
+    ///
+    /// @brief      Work out the flags of one sector from the extents.
+    ///
+    /// @param[in]  sector
+    ///             The flash sector.
+    ///
+    /// @return     The FLAG_ bits for the sector.
+    ///
+    uint8_t flagSector(uint32_t sector) const;
+
+    ///
+    /// @brief      Work out the CRC-32 of one sector from the extents.
+    ///
+    /// @param[in]  sector
+    ///             The flash sector.
+    ///
+    /// @return     The CRC-32 of the whole sector.
+    ///
+    uint32_t crcSector(uint32_t sector) const;
+
+    ///
+    /// @brief      Find the first extent ending past an address.
+    ///
+    /// @param[in]  address
+    ///             The address.
+    ///
+    /// @return     Index of the extent, or the number of extents if
+    ///             there is none.
+    ///
+    size_t find(uint64_t address) const;
+
+    // Data members
+    std::vector<Extent>     mExtents;
+    std::vector<uint8_t>    mSectorFlags;
+    std::vector<uint32_t>   mSectorCRCs;
+    uint8_t                 mFill;
+    bool                    mIsIndexed;
+};  // class
+
+} // namespace
+#endif
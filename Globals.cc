@@ -0,0 +1,29 @@
+///
+/// @file   Globals.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+/// The settings and the firmware image shared by the client modules.  They
+/// live apart from main() so the benchmark can link the same modules.
+///
+
+//  Includes
+#include <stdint.h>
+#include "Client.hh"
+#include "FirmwareImage.hh"
+
+
+//  Global variables
+bool        gIsVerbose          = false;
+bool        gIsActiveLowReset   = true;
+bool        gQuit               = false;
+bool        gNoGPIO             = false;
+unsigned    gSyncRetries        = 2;
+uint32_t    gStageSize          = isp::Part::SECTOR_SIZE;
+bool        gIsDelta            = true;
+unsigned    gMaxBaud            = 460800;
+bool        gIsLowLatency       = false;
+bool        gIsRtsCts           = false;
+bool        gIsPipeline         = false;
+isp::FirmwareImage  gImage;
@@ -0,0 +1,201 @@
+///
+/// @file   Gpio.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "Gpio.hh"
+#include "Log.hh"
+
+
+//  External References
+extern  bool    gIsActiveLowReset;
+
+
+//  Static variables
+static std::string sBackendName = "gpiochip";
+
+//  Fixture timing, in the order setup, reset pulse, hold (us) and boot (ms).
+//  "datasheet" is the LPC15xx minimum with margin for GPIO write latency,
+//  "filtered" suits fixtures with an RC filter on RESET, and "legacy" is
+//  the original fixed sequence.
+static const isp::GpioProfile sProfiles[] =
+{
+    { "datasheet",      10,    100,   3000,  200 },
+    { "filtered",     1000,  10000,  20000,  200 },
+    { "legacy",     100000, 500000, 100000,  100 }
+};
+
+static const isp::GpioProfile * spProfile = &sProfiles[ 0 ];
+
+
+//
+//  @brief      Wait until a time after a monotonic time stamp.
+//
+static void sleepUntil(struct timespec& when, unsigned delayInUS)
+{
+    when.tv_nsec += static_cast<long>(delayInUS) * 1000L;
+    when.tv_sec  += when.tv_nsec / 1000000000L;
+    when.tv_nsec %= 1000000000L;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, nullptr) == EINTR)
+        ;
+}
+
+
+//
+//  @brief      Get the process-wide GPIO instance.
+//
+isp::Gpio& isp::Gpio::getInstance()
+{
+    static Gpio sInstance;
+
+    return sInstance;
+}
+
+
+//
+//  @brief      Select the backend.
+//
+bool isp::Gpio::setBackend(const std::string& name)
+{
+    if (!isp::GpioBackend::isName(name))
+        return false;
+
+    sBackendName = name;
+    return true;
+}
+
+
+//
+//  @brief      Find a fixture timing profile by name.
+//
+const isp::GpioProfile * isp::Gpio::findProfile(const char * name)
+{
+    for (const GpioProfile& profile : sProfiles)
+    {
+        if (strcmp(profile.name, name) == 0)
+            return &profile;
+    }
+    return nullptr;
+}
+
+
+//
+//  @brief      Get the names of all profiles.
+//
+const char * isp::Gpio::getProfileNames()
+{
+    return "datasheet|filtered|legacy";
+}
+
+
+//
+//  @brief      Select the timing profile.
+//
+void isp::Gpio::setProfile(const isp::GpioProfile& profile)
+{
+    spProfile = &profile;
+}
+
+
+//
+//  @brief      Get the selected timing profile.
+//
+const isp::GpioProfile& isp::Gpio::getProfile()
+{
+    return *spProfile;
+}
+
+
+//
+//  @brief      Default constructor; opens the lines.
+//
+isp::Gpio::Gpio()
+{
+    // Idle with reset released, UART ISP deselected and the LED off
+    unsigned values = isp::GpioBackend::mask(isp::GpioBackend::LINE_ISP0) |
+                      isp::GpioBackend::mask(isp::GpioBackend::LINE_ISP1);
+
+    if (gIsActiveLowReset)
+        values |= isp::GpioBackend::mask(isp::GpioBackend::LINE_RESET);
+
+    mpBackend = isp::GpioBackend::create(sBackendName, values);
+    if (!mpBackend->isOpen() && sBackendName == "gpiochip")
+    {
+        LOG(WARNING) << "Falling back to sysfs GPIO";
+        delete mpBackend;
+        mpBackend = isp::GpioBackend::create("sysfs", values);
+    }
+    LOG(INFO) << "GPIO backend: " << mpBackend->getName();
+}
+
+
+//
+//  @brief      Default destructor; closes the lines.
+//
+isp::Gpio::~Gpio()
+{
+    delete mpBackend;
+}
+
+
+//
+//  @brief      Reset the target with the ISP lines low.
+//
+void isp::Gpio::enterISP(bool isActiveLowReset)
+{
+    pulse(true, isActiveLowReset);
+}
+
+
+//
+//  @brief      Reset the target with the ISP lines high.
+//
+void isp::Gpio::enterApplication(bool isActiveLowReset)
+{
+    pulse(false, isActiveLowReset);
+}
+
+
+//
+//  @brief      Set the LED.
+//
+void isp::Gpio::setLED(bool value)
+{
+    mpBackend->set(isp::GpioBackend::mask(isp::GpioBackend::LINE_LED),
+                   value? isp::GpioBackend::mask(isp::GpioBackend::LINE_LED): 0U);
+}
+
+
+//
+//  @brief      Pulse the reset line with the ISP lines at a level.
+//
+void isp::Gpio::pulse(bool isISP, bool isActiveLowReset)
+{
+    isp::Lock<isp::Mutex> lock(mMutex);
+    const GpioProfile& profile = getProfile();
+    const unsigned select = isp::GpioBackend::mask(isp::GpioBackend::LINE_ISP0) |
+                            isp::GpioBackend::mask(isp::GpioBackend::LINE_ISP1);
+    const unsigned reset = isp::GpioBackend::mask(isp::GpioBackend::LINE_RESET);
+    struct timespec when;
+
+    clock_gettime(CLOCK_MONOTONIC, &when);
+
+    // ISP0,1 LOW selects UART ISP, HIGH runs the application
+    mpBackend->set(select, isISP? 0U: select);
+    sleepUntil(when, profile.setupUS);
+
+    // Assert reset active
+    mpBackend->set(reset, isActiveLowReset? 0U: reset);
+    sleepUntil(when, profile.resetUS);
+
+    // Deassert reset and hold ISP0,1 until the boot ROM samples them
+    mpBackend->set(reset, isActiveLowReset? reset: 0U);
+    sleepUntil(when, profile.holdUS);
+}
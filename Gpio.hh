@@ -0,0 +1,188 @@
+///
+/// @file   Gpio.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef GPIO_HH_
+#define GPIO_HH_
+
+//  Includes
+#include <string>
+#include "GpioBackend.hh"
+#include "Mutex.hh"
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Reset and ISP entry timing for one fixture.
+///
+struct GpioProfile
+{
+    const char *    name;           ///< Profile name for --profile
+    unsigned        setupUS;        ///< ISP pins settle before reset
+    unsigned        resetUS;        ///< Reset pulse width
+    unsigned        holdUS;         ///< ISP pins held after reset release
+    unsigned        bootMS;         ///< Time allowed for the bootloader to answer
+};
+
+///
+/// @brief      GPIO sequencing for the RESET and ISP lines.
+///
+/// @details    This class drives the target RESET, ISP0 and ISP1 lines
+///             and the LED through a GpioBackend.  The lines are claimed
+///             once and stay claimed for the life of the process, and the
+///             pulse timing comes from a fixture profile instead of fixed
+///             sleeps.
+///
+class Gpio
+{
+public:
+    ///
+    /// @brief      Get the process-wide GPIO instance.
+    ///
+    /// @return     Reference to the instance; the lines are opened on the
+    ///             first call.
+    ///
+    static Gpio& getInstance();
+
+    ///
+    /// @brief      Select the backend.
+    ///
+    /// @details    Takes effect only before the first getInstance.  The
+    ///             default is "gpiochip", which falls back to "sysfs" when
+    ///             the character device cannot be claimed.
+    ///
+    /// @param[in]  name
+    ///             The backend name.
+    ///
+    /// @return     Boolean false if the name is not known.
+    ///
+    static bool setBackend(const std::string& name);
+
+    ///
+    /// @brief      Get the backend in use.
+    ///
+    /// @return     Reference to the backend.
+    ///
+    GpioBackend& getBackend() { return *mpBackend; }
+
+    ///
+    /// @brief      Find a fixture timing profile by name.
+    ///
+    /// @param[in]  name
+    ///             The profile name.
+    ///
+    /// @return     Pointer to the profile, or nullptr if it is not known.
+    ///
+    static const GpioProfile * findProfile(const char * name);
+
+    ///
+    /// @brief      Get the names of all profiles.
+    ///
+    /// @return     The names separated by '|'.
+    ///
+    static const char * getProfileNames();
+
+    ///
+    /// @brief      Select the timing profile.
+    ///
+    /// @param[in]  profile
+    ///             Reference to one of the profiles from findProfile.
+    ///
+    static void setProfile(const GpioProfile& profile);
+
+    ///
+    /// @brief      Get the selected timing profile.
+    ///
+    /// @details    The profile is also used without GPIO to bound the time
+    ///             spent probing for the bootloader.
+    ///
+    /// @return     Reference to the profile.
+    ///
+    static const GpioProfile& getProfile();
+
+    ///
+    /// @brief      Reset the target with the ISP lines low.
+    ///
+    /// @details    Returns once the ISP lines have been held for the
+    ///             profile hold time; the caller then probes for the
+    ///             bootloader rather than waiting a fixed time for it.
+    ///
+    /// @param[in]  isActiveLowReset
+    ///             The boolean flag for reset polarity.
+    ///
+    void enterISP(bool isActiveLowReset);
+
+    ///
+    /// @brief      Reset the target with the ISP lines high.
+    ///
+    /// @param[in]  isActiveLowReset
+    ///             The boolean flag for reset polarity.
+    ///
+    void enterApplication(bool isActiveLowReset);
+
+    ///
+    /// @brief      Set the LED.
+    ///
+    /// @details    Safe to call from a signal handler; the LED never shares
+    ///             a write with the other lines.
+    ///
+    /// @param[in]  value
+    ///             The boolean value to drive.
+    ///
+    void setLED(bool value);
+
+private:
+    ///
+    /// @brief      Default constructor; opens the lines.
+    ///
+    Gpio();
+
+    ///
+    /// @brief      Default destructor; closes the lines.
+    ///
+    ~Gpio();
+
+    ///
+    /// @brief      Gpio copy constructor (non-copyable)
+    ///
+    /// @details    Make the class non-copyable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a Gpio instance to copy from.
+    ///
+    Gpio(const Gpio& ref) = delete;
+
+    ///
+    /// @brief      Gpio assignment operator (not-assignable)
+    ///
+    /// @details    Make the class non-assignable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a Gpio instance to copy from.
+    ///
+    /// @return     New instance for the left-hand side of the expression.
+    ///
+    Gpio& operator = (const Gpio& ref) = delete;
+
+    ///
+    /// @brief      Pulse the reset line with the ISP lines at a level.
+    ///
+    /// @param[in]  isISP
+    ///             Drive the ISP lines low for ISP mode when true.
+    ///
+    /// @param[in]  isActiveLowReset
+    ///             The boolean flag for reset polarity.
+    ///
+    void pulse(bool isISP, bool isActiveLowReset);
+
+    // Data members
+    GpioBackend *           mpBackend;
+    isp::Mutex              mMutex;
+};  // class
+
+} // namespace
+#endif
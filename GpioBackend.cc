@@ -0,0 +1,280 @@
+///
+/// @file   GpioBackend.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "GpioBackend.hh"
+#include "Log.hh"
+
+
+//  Definitions
+#define GPIO_CHIP   "/dev/gpiochip0"
+#define GPIO_LABEL  "isp15xx"
+
+
+//  Static variables
+//  BCM GPIO numbers, in Line order
+static const unsigned sOffsets[ isp::GpioBackend::LINE_COUNT ] =
+{
+    17, 18, 27, 25
+};
+
+
+//
+//  @brief      Create a backend by name.
+//
+isp::GpioBackend * isp::GpioBackend::create(const std::string& name, unsigned values)
+{
+    if (name == "gpiochip")
+        return new ChipGpio(values);
+    if (name == "sysfs")
+        return new SysfsGpio(values);
+    if (name == "sim")
+        return new SimGpio(values);
+    return nullptr;
+}
+
+
+//
+//  @brief      Check a backend name.
+//
+bool isp::GpioBackend::isName(const std::string& name)
+{
+    return name == "gpiochip" || name == "sysfs" || name == "sim";
+}
+
+
+//
+//  @brief      Get the line offset on the GPIO controller.
+//
+unsigned isp::GpioBackend::getOffset(isp::GpioBackend::Line line)
+{
+    return sOffsets[ line ];
+}
+
+
+//
+//  @brief      Explicit constructor; opens the value files.
+//
+isp::SysfsGpio::SysfsGpio(unsigned values)
+{
+    for (unsigned ii = 0; ii < LINE_COUNT; ++ii)
+    {
+        std::string path = "/sys/class/gpio/gpio" +
+                           std::to_string(getOffset(static_cast<Line>(ii))) +
+                           "/value";
+
+        mFileDes[ ii ] = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (mFileDes[ ii ] < 0)
+        {
+            LOG(ERROR) << "Open failed for signal '"
+                       << path
+                       << "' -- " << errno << " " << strerror(errno);
+        }
+    }
+    set((1U << LINE_COUNT) - 1, values);
+}
+
+
+//
+//  @brief      Destructor; closes the value files.
+//
+isp::SysfsGpio::~SysfsGpio()
+{
+    for (unsigned ii = 0; ii < LINE_COUNT; ++ii)
+    {
+        if (mFileDes[ ii ] >= 0)
+            close(mFileDes[ ii ]);
+    }
+}
+
+
+//
+//  @brief      Check that the lines were claimed.
+//
+bool isp::SysfsGpio::isOpen() const
+{
+    return mFileDes[ LINE_RESET ] >= 0 &&
+           mFileDes[ LINE_ISP0 ] >= 0 &&
+           mFileDes[ LINE_ISP1 ] >= 0;
+}
+
+
+//
+//  @brief      Drive a set of lines.
+//
+bool isp::SysfsGpio::set(unsigned lines, unsigned values)
+{
+    bool isOK = true;
+
+    for (unsigned ii = 0; ii < LINE_COUNT; ++ii)
+    {
+        // A sysfs value file takes a write at offset zero each time
+        if ((lines & (1U << ii)) && mFileDes[ ii ] >= 0 &&
+            pwrite(mFileDes[ ii ], (values & (1U << ii))? "1\n": "0\n", 2, 0) < 0)
+        {
+            isOK = false;
+        }
+    }
+    return isOK;
+}
+
+
+//
+//  @brief      Explicit constructor; claims the lines.
+//
+isp::ChipGpio::ChipGpio(unsigned values)
+        : mControlFD(-1),
+          mLEDFD(-1),
+          mValues(values)
+{
+    int chip = open(GPIO_CHIP, O_RDONLY | O_CLOEXEC);
+
+    if (chip < 0)
+    {
+        LOG(WARNING) << "Open failed for '" GPIO_CHIP "' -- "
+                     << errno << " " << strerror(errno);
+        return;
+    }
+
+    mControlFD = request(chip, LINE_RESET, 3);
+    mLEDFD     = request(chip, LINE_LED, 1);
+    close(chip);
+}
+
+
+//
+//  @brief      Destructor; releases the lines.
+//
+isp::ChipGpio::~ChipGpio()
+{
+    if (mControlFD >= 0)
+        close(mControlFD);
+    if (mLEDFD >= 0)
+        close(mLEDFD);
+}
+
+
+//
+//  @brief      Claim lines as outputs.
+//
+int isp::ChipGpio::request(int chip, isp::GpioBackend::Line first, unsigned count)
+{
+    struct gpiohandle_request req;
+
+    memset(&req, 0, sizeof(req));
+    for (unsigned ii = 0; ii < count; ++ii)
+    {
+        Line line = static_cast<Line>(first + ii);
+
+        req.lineoffsets[ ii ]    = getOffset(line);
+        req.default_values[ ii ] = (mValues & mask(line))? 1: 0;
+    }
+    req.flags = GPIOHANDLE_REQUEST_OUTPUT;
+    req.lines = count;
+    strncpy(req.consumer_label, GPIO_LABEL, sizeof(req.consumer_label) - 1);
+
+    if (ioctl(chip, GPIO_GET_LINEHANDLE_IOCTL, &req) < 0)
+    {
+        LOG(WARNING) << "Line request failed on '" GPIO_CHIP "' for line "
+                     << getOffset(first) << " -- " << errno << " " << strerror(errno);
+        return -1;
+    }
+    return req.fd;
+}
+
+
+//
+//  @brief      Drive a set of lines.
+//
+bool isp::ChipGpio::set(unsigned lines, unsigned values)
+{
+    const unsigned control = mask(LINE_RESET) | mask(LINE_ISP0) | mask(LINE_ISP1);
+    struct gpiohandle_data data;
+    bool isOK = true;
+
+    if ((lines & control) && mControlFD >= 0)
+    {
+        // The handle sets every line it holds, so merge with the others
+        unsigned next = (mValues & ~lines) | (values & lines);
+
+        memset(&data, 0, sizeof(data));
+        for (unsigned ii = 0; ii < 3; ++ii)
+            data.values[ ii ] = (next & (1U << (LINE_RESET + ii)))? 1: 0;
+
+        if (ioctl(mControlFD, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0)
+            isOK = false;
+        else
+            mValues = (mValues & ~control) | (next & control);
+    }
+
+    if ((lines & mask(LINE_LED)) && mLEDFD >= 0)
+    {
+        memset(&data, 0, sizeof(data));
+        data.values[ 0 ] = (values & mask(LINE_LED))? 1: 0;
+
+        if (ioctl(mLEDFD, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0)
+            isOK = false;
+    }
+    return isOK;
+}
+
+
+//
+//  @brief      Explicit constructor for the SimGpio class.
+//
+isp::SimGpio::SimGpio(unsigned values)
+        : mValues(values & ~mask(LINE_LED)),
+          mLED((values & mask(LINE_LED))? 1: 0)
+{
+    mEdges.reserve(MAX_EDGES);
+}
+
+
+//
+//  @brief      Drive a set of lines.
+//
+bool isp::SimGpio::set(unsigned lines, unsigned values)
+{
+    struct timespec now;
+
+    // The LED is set from SIGALRM, where a plain store is all that is safe
+    if (lines & mask(LINE_LED))
+        mLED = (values & mask(LINE_LED))? 1: 0;
+
+    lines &= ~mask(LINE_LED);
+    if (lines == 0U)
+        return true;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (unsigned ii = 0; ii < LINE_COUNT; ++ii)
+    {
+        unsigned bit = 1U << ii;
+
+        if ((lines & bit) && ((mValues ^ values) & bit))
+        {
+            Edge edge;
+
+            mValues ^= bit;
+            edge.timeInNS = static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+            edge.line     = static_cast<Line>(ii);
+            edge.value    = (values & bit) != 0;
+
+            if (mEdges.size() < MAX_EDGES)
+                mEdges.push_back(edge);
+            if (mListener)
+                mListener(edge, mValues);
+        }
+    }
+    return true;
+}
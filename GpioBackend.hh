@@ -0,0 +1,301 @@
+///
+/// @file   GpioBackend.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef GPIOBACKEND_HH_
+#define GPIOBACKEND_HH_
+
+//  Includes
+#include <signal.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Interface to the GPIO lines of the fixture.
+///
+/// @details    A backend drives the RESET, ISP0, ISP1 and LED lines.  Lines
+///             are addressed with bit masks so that a backend able to set
+///             several lines in one operation can do so.
+///
+class GpioBackend
+{
+public:
+    typedef enum {
+        LINE_RESET,             ///< Target reset
+        LINE_ISP0,              ///< Boot mode select 0
+        LINE_ISP1,              ///< Boot mode select 1
+        LINE_LED,               ///< Activity LED
+        LINE_COUNT
+    } Line;
+
+    ///
+    /// @brief      Get the bit mask of a line.
+    ///
+    /// @param[in]  line
+    ///             The line.
+    ///
+    /// @return     The mask with the bit of the line set.
+    ///
+    static unsigned mask(Line line) { return 1U << line; }
+
+    ///
+    /// @brief      Create a backend by name.
+    ///
+    /// @param[in]  name
+    ///             The backend name; one of the names from getNames.
+    ///
+    /// @param[in]  values
+    ///             The bit mask of line values to drive when the lines are
+    ///             claimed.
+    ///
+    /// @return     Pointer to the new backend owned by the caller, or nullptr
+    ///             if the name is not known.
+    ///
+    static GpioBackend * create(const std::string& name, unsigned values);
+
+    ///
+    /// @brief      Check a backend name.
+    ///
+    /// @param[in]  name
+    ///             The backend name.
+    ///
+    /// @return     Boolean true if create accepts the name.
+    ///
+    static bool isName(const std::string& name);
+
+    ///
+    /// @brief      Get the names of all backends.
+    ///
+    /// @return     The names separated by '|'.
+    ///
+    static const char * getNames() { return "gpiochip|sysfs|sim"; }
+
+    ///
+    /// @brief      Default destructor for the GpioBackend class.
+    ///
+    virtual ~GpioBackend() {}
+
+    ///
+    /// @brief      Get the backend name.
+    ///
+    /// @return     The name used by create.
+    ///
+    virtual const char * getName() const = 0;
+
+    ///
+    /// @brief      Check that the lines were claimed.
+    ///
+    /// @return     Boolean true if the lines can be driven.
+    ///
+    virtual bool isOpen() const = 0;
+
+    ///
+    /// @brief      Drive a set of lines.
+    ///
+    /// @details    The LED line must be independent of the others since it
+    ///             is driven from the SIGALRM handler.
+    ///
+    /// @param[in]  lines
+    ///             The bit mask of lines to drive.
+    ///
+    /// @param[in]  values
+    ///             The bit mask of values for those lines.
+    ///
+    /// @return     Boolean true on success.
+    ///
+    virtual bool set(unsigned lines, unsigned values) = 0;
+
+protected:
+    ///
+    /// @brief      Get the line offset on the GPIO controller.
+    ///
+    /// @param[in]  line
+    ///             The line.
+    ///
+    /// @return     The BCM GPIO number of the line.
+    ///
+    static unsigned getOffset(Line line);
+};  // class
+
+
+///
+/// @brief      GPIO through the /sys/class/gpio value files.
+///
+class SysfsGpio : public GpioBackend
+{
+public:
+    ///
+    /// @brief      Explicit constructor; opens the value files.
+    ///
+    /// @param[in]  values
+    ///             The bit mask of line values to drive.
+    ///
+    explicit SysfsGpio(unsigned values);
+
+    ///
+    /// @brief      Destructor; closes the value files.
+    ///
+    virtual ~SysfsGpio();
+
+    virtual const char * getName() const { return "sysfs"; }
+    virtual bool isOpen() const;
+    virtual bool set(unsigned lines, unsigned values);
+
+private:
+    SysfsGpio() = delete;
+    SysfsGpio(const SysfsGpio& ref) = delete;
+    SysfsGpio& operator = (const SysfsGpio& ref) = delete;
+
+    // Data members
+    int             mFileDes[ LINE_COUNT ];
+};  // class
+
+
+///
+/// @brief      GPIO through a /dev/gpiochip line handle.
+///
+/// @details    RESET, ISP0 and ISP1 are claimed as one line handle so that
+///             they change together in one ioctl.  The LED has a handle of
+///             its own so that it never touches the other lines.
+///
+class ChipGpio : public GpioBackend
+{
+public:
+    ///
+    /// @brief      Explicit constructor; claims the lines.
+    ///
+    /// @param[in]  values
+    ///             The bit mask of line values to drive.
+    ///
+    explicit ChipGpio(unsigned values);
+
+    ///
+    /// @brief      Destructor; releases the lines.
+    ///
+    virtual ~ChipGpio();
+
+    virtual const char * getName() const { return "gpiochip"; }
+    virtual bool isOpen() const { return mControlFD >= 0; }
+    virtual bool set(unsigned lines, unsigned values);
+
+private:
+    ChipGpio() = delete;
+    ChipGpio(const ChipGpio& ref) = delete;
+    ChipGpio& operator = (const ChipGpio& ref) = delete;
+
+    ///
+    /// @brief      Claim lines as outputs.
+    ///
+    /// @param[in]  chip
+    ///             The file descriptor of the chip.
+    ///
+    /// @param[in]  first
+    ///             The first line of the handle.
+    ///
+    /// @param[in]  count
+    ///             The number of consecutive lines in the handle.
+    ///
+    /// @return     The line handle file descriptor, or negative on error.
+    ///
+    int request(int chip, Line first, unsigned count);
+
+    // Data members
+    int             mControlFD;
+    int             mLEDFD;
+    unsigned        mValues;
+};  // class
+
+
+///
+/// @brief      Simulated GPIO that records each edge.
+///
+/// @details    Nothing is driven; each change of a line is kept with its
+///             time so that entry sequences can be checked and timed
+///             without a fixture.  A listener may stand in for the target
+///             and act on each change.  The LED is driven from SIGALRM, so
+///             it is only stored, and never recorded or passed on.
+///
+class SimGpio : public GpioBackend
+{
+public:
+    ///
+    /// @brief      One recorded change of a line.
+    ///
+    typedef struct
+    {
+        uint64_t    timeInNS;       ///< CLOCK_MONOTONIC time of the change
+        Line        line;           ///< The line that changed
+        bool        value;          ///< The new value
+    } Edge;
+
+    typedef std::function<void (const Edge& edge, unsigned values)> tListener;
+
+    static const size_t MAX_EDGES = 4096;
+
+    ///
+    /// @brief      Explicit constructor for the SimGpio class.
+    ///
+    /// @param[in]  values
+    ///             The bit mask of initial line values.
+    ///
+    explicit SimGpio(unsigned values);
+
+    virtual ~SimGpio() {}
+
+    virtual const char * getName() const { return "sim"; }
+    virtual bool isOpen() const { return true; }
+    virtual bool set(unsigned lines, unsigned values);
+
+    ///
+    /// @brief      Get the recorded edges.
+    ///
+    /// @details    Recording stops at MAX_EDGES so that set never
+    ///             allocates.
+    ///
+    /// @return     Reference to the edges, oldest first.
+    ///
+    const std::vector<Edge>& getEdges() const { return mEdges; }
+
+    ///
+    /// @brief      Discard the recorded edges.
+    ///
+    void clear() { mEdges.clear(); }
+
+    ///
+    /// @brief      Set the function called for each change of a line.
+    ///
+    /// @param[in]  listener
+    ///             The function, given the edge and the line values after
+    ///             it; empty for none.
+    ///
+    void setListener(const tListener& listener) { mListener = listener; }
+
+    ///
+    /// @brief      Get the current line values.
+    ///
+    /// @return     The bit mask of line values.
+    ///
+    unsigned getValues() const { return mValues | (mLED? mask(LINE_LED): 0U); }
+
+private:
+    SimGpio() = delete;
+    SimGpio(const SimGpio& ref) = delete;
+    SimGpio& operator = (const SimGpio& ref) = delete;
+
+    // Data members
+    std::vector<Edge>   mEdges;
+    unsigned            mValues;
+    volatile sig_atomic_t mLED;
+    tListener           mListener;
+};  // class
+
+} // namespace
+#endif
@@ -0,0 +1,411 @@
+///
+/// @file   HexBench.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+
+//  Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CmdLine.hh"
+#include "FirmwareImage.hh"
+#include "HexDecoder.hh"
+#include "iHex.hh"
+#include "Log.hh"
+#include "Utility.hh"
+
+
+//  Definitions
+//  Data bytes per record, as written by objcopy
+#define RECORD_BYTES    (16U)
+
+
+//  Type definitions
+typedef struct
+{
+    size_t          offset;         ///< Offset of the data digits in the text
+    uint32_t        address;        ///< Image address of the first byte
+} tRecord;
+
+
+///
+/// @brief      Get the milliseconds since a monotonic time stamp.
+///
+/// @param[in]  start
+///             The time stamp.
+///
+/// @return     The elapsed time in milliseconds.
+///
+static double elapsedMS(const struct timespec& start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000.0 +
+           (now.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+
+///
+/// @brief      Append one Intel Hex record to the text.
+///
+/// @param[out] text
+///             The text to append to.
+///
+/// @param[in]  type
+///             The record type.
+///
+/// @param[in]  address
+///             The 16-bit record address.
+///
+/// @param[in]  pData
+///             The record data.
+///
+/// @param[in]  count
+///             The number of data bytes.
+///
+static void addRecord(std::string& text,
+                      unsigned type,
+                      unsigned address,
+                      const uint8_t * pData,
+                      unsigned count)
+{
+    char     line[ 16 + 2 * 255 ];
+    unsigned sum = count + (address >> 8) + (address & 0xFF) + type;
+    int      length = snprintf(line, sizeof(line), ":%02X%04X%02X", count, address, type);
+
+    for (unsigned ii = 0; ii < count; ++ii)
+    {
+        length += snprintf(line + length, sizeof(line) - length, "%02X", pData[ ii ]);
+        sum += pData[ ii ];
+    }
+    length += snprintf(line + length, sizeof(line) - length, "%02X\n", (0x100 - (sum & 0xFF)) & 0xFF);
+    text.append(line, length);
+}
+
+
+///
+/// @brief      Build a synthetic Intel Hex file.
+///
+/// @details    The image is pseudo-random data from address zero, with an
+///             extended linear address record at each 64 KB boundary.  The
+///             generator is seeded the same way every run.
+///
+/// @param[in]  size
+///             The approximate size of the text in bytes.
+///
+/// @param[out] text
+///             The text of the file.
+///
+/// @param[out] records
+///             The data records, for timing the decode alone.
+///
+/// @return     The number of bytes in the image.
+///
+static uint32_t makeHex(size_t size,
+                        std::string& text,
+                        std::vector<tRecord>& records)
+{
+    uint32_t seed = 0x1549U;
+    uint32_t address = 0U;
+    uint8_t  data[ RECORD_BYTES ];
+
+    text.clear();
+    text.reserve(size + 64);
+    records.clear();
+
+    while (text.size() < size)
+    {
+        if ((address & 0xFFFFU) == 0U)
+        {
+            uint8_t upper[ 2 ] = { static_cast<uint8_t>(address >> 24),
+                                   static_cast<uint8_t>(address >> 16) };
+
+            addRecord(text, 4, 0, upper, 2);
+        }
+
+        for (unsigned ii = 0; ii < RECORD_BYTES; ++ii)
+        {
+            seed = seed * 1103515245U + 12345U;
+            data[ ii ] = static_cast<uint8_t>(seed >> 16);
+        }
+
+        tRecord record = { text.size() + 9, address };
+
+        records.push_back(record);
+        addRecord(text, 0, address & 0xFFFFU, data, RECORD_BYTES);
+        address += RECORD_BYTES;
+    }
+    addRecord(text, 1, 0, nullptr, 0);
+    return address;
+}
+
+
+///
+/// @brief      Parse a file the way iHex did with stringToByte.
+///
+/// @details    Each line is read with getline, copied without its ':' and
+///             decoded into a fresh vector, then copied into the image.
+///
+/// @param[in]  filename
+///             The file to parse.
+///
+/// @param[out] pImage
+///             The image to fill in.
+///
+/// @return     Boolean false on a checksum mismatch.
+///
+static bool parseLegacy(const char * filename, uint8_t * pImage)
+{
+    std::ifstream inFile(filename);
+    std::string   line;
+    uint32_t      offset = 0U;
+
+    while (getline(inFile, line))
+    {
+        std::vector<uint8_t> bytes;
+        std::vector<uint8_t> data;
+        unsigned checksum = 0U;
+
+        isp::Utility::stringToByte(line.substr(1), bytes);
+        if (bytes.size() < 5)
+            return false;
+
+        unsigned count = bytes[ 0 ];
+
+        for (unsigned ii = 0; ii < count; ++ii)
+            data.push_back(bytes[ 4 + ii ]);
+        for (uint8_t byte : bytes)
+            checksum += byte;
+        if (checksum & 0xFF)
+            return false;
+
+        if (bytes[ 3 ] == 0)
+        {
+            uint32_t base = offset + ((bytes[ 1 ] << 8) | bytes[ 2 ]);
+
+            for (unsigned ii = 0; ii < data.size(); ++ii)
+                pImage[ base + ii ] = data[ ii ];
+        }
+        else if (bytes[ 3 ] == 4)
+        {
+            offset = ((data[ 0 ] << 8) | data[ 1 ]) << 16;
+        }
+    }
+    return true;
+}
+
+
+///
+/// @brief      Report one path at one size.
+///
+/// @param[in]  size
+///             The size of the text in bytes.
+///
+/// @param[in]  path
+///             The name of the decode path.
+///
+/// @param[in]  decodeMS
+///             The best time to decode the data records alone.
+///
+/// @param[in]  parseMS
+///             The best time to parse the file.
+///
+static void report(size_t size, const char * path, double decodeMS, double parseMS)
+{
+    std::ostringstream json;
+
+    json << std::fixed << std::setprecision(3)
+         << "{\"hex_bytes\":" << size
+         << ",\"path\":\"" << path << "\""
+         << ",\"decode_ms\":" << decodeMS
+         << ",\"parse_ms\":" << parseMS
+         << ",\"parse_mb_per_s\":" << (size / 1048576.0) / (parseMS / 1000.0)
+         << "}";
+    std::cout << json.str() << std::endl;
+}
+
+
+///
+/// @brief      Time every decode path on one synthetic file.
+///
+/// @param[in]  megabytes
+///             The size of the file in megabytes.
+///
+/// @param[in]  runs
+///             The number of runs of each path; the best is reported.
+///
+/// @return     Boolean false if a path decodes the image wrongly.
+///
+static bool runSize(unsigned megabytes, unsigned runs)
+{
+    std::string          text;
+    std::vector<tRecord> records;
+    char                 filename[] = "/tmp/hexbench-XXXXXX";
+    uint32_t             imageSize = makeHex(megabytes * 1048576U, text, records);
+    std::vector<uint8_t> expected(imageSize);
+    std::vector<uint8_t> image(imageSize);
+    bool                 isOK = true;
+
+    int fileDes = mkstemp(filename);
+    if (fileDes < 0 ||
+        write(fileDes, text.data(), text.size()) != static_cast<ssize_t>(text.size()))
+    {
+        std::cerr << "Cannot write " << filename << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    close(fileDes);
+
+    // The reference image, from the original path
+    {
+        double decodeMS = 1e9;
+        double parseMS = 1e9;
+
+        for (unsigned run = 0; run < runs; ++run)
+        {
+            struct timespec start;
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (const tRecord& record : records)
+            {
+                std::vector<uint8_t> bytes;
+
+                isp::Utility::stringToByte(text.substr(record.offset, 2 * RECORD_BYTES), bytes);
+                memcpy(&expected[ record.address ], bytes.data(), bytes.size());
+            }
+            decodeMS = std::min(decodeMS, elapsedMS(start));
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            isOK = parseLegacy(filename, expected.data()) && isOK;
+            parseMS = std::min(parseMS, elapsedMS(start));
+        }
+        report(text.size(), "stringToByte", decodeMS, parseMS);
+    }
+
+    for (int kernel = 0; kernel < isp::HexDecoder::KERNEL_COUNT; ++kernel)
+    {
+        isp::HexDecoder::Kernel selected = static_cast<isp::HexDecoder::Kernel>(kernel);
+        double decodeMS = 1e9;
+        double parseMS = 1e9;
+
+        if (!isp::HexDecoder::setKernel(selected))
+            continue;
+
+        for (unsigned run = 0; run < runs; ++run)
+        {
+            struct timespec start;
+            unsigned sum = 0U;
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (const tRecord& record : records)
+            {
+                isp::HexDecoder::decode(reinterpret_cast<const uint8_t *>(text.data()) + record.offset,
+                                        RECORD_BYTES, &image[ record.address ], sum);
+            }
+            decodeMS = std::min(decodeMS, elapsedMS(start));
+
+            isp::FirmwareImage firmware;
+            isp::iHex hexFile(filename, firmware);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            isOK = hexFile.parse() && isOK;
+            parseMS = std::min(parseMS, elapsedMS(start));
+
+            if (run == runs - 1)
+                firmware.read(0U, image.data(), image.size());
+        }
+
+        // iHex patches the vector table checksum; compare past it
+        if (memcmp(image.data() + 32, expected.data() + 32, imageSize - 32) != 0)
+        {
+            std::cerr << isp::HexDecoder::getName(selected) << " decoded the image wrongly" << std::endl;
+            isOK = false;
+        }
+        report(text.size(), isp::HexDecoder::getName(selected), decodeMS, parseMS);
+    }
+
+    unlink(filename);
+    return isOK;
+}
+
+
+///
+/// @brief      Application entry point.
+///
+/// @details    Time the original stringToByte decode against each hex
+///             decode kernel supported here, on synthetic Intel Hex files
+///             of 1, 10 and 100 MB, and print one JSON line per path.
+///
+/// @param[in]  argc    Number of command line arguments, including
+///                     the invoking program name.
+/// @param[in]  argv    List of constant c-strings for each argument,
+///                     starting with the program name itself at the
+///                     index of zero.
+///
+/// @retval     0       Success.
+/// @retval     <other> Unix-style error codes.
+///
+int main(int argc,
+         char * const argv[] )
+{
+    isp::CmdLine    cmdLine(argc, argv);
+    size_t          index = -1;
+    std::string     argument;
+    unsigned        only = 0U;
+    unsigned        runs = 3U;
+    int             returnCode = 0;
+    const unsigned  sizes[] = { 1, 10, 100 };
+
+    if (cmdLine.find("--help", index) || cmdLine.find("-h", index))
+    {
+        std::cerr << "Intel Hex decode benchmark"                           << std::endl;
+        std::cerr << ""                                                     << std::endl;
+        std::cerr << "Usage:"                                               << std::endl;
+        std::cerr << "isp15xx-hexbench [OPTIONS]"                           << std::endl;
+        std::cerr << " OPTIONS:"                                            << std::endl;
+        std::cerr << "  --size   | -s    Run only this size in MB"          << std::endl;
+        std::cerr << "  --runs   | -n    Runs of each path (3)"             << std::endl;
+        std::cerr << "  --help   | -h    Show this help"                    << std::endl;
+        exit(0);
+    }
+
+    if ((cmdLine.find("--size", index) || cmdLine.find("-s", index)) &&
+        cmdLine.get(index + 1, argument))
+    {
+        only = static_cast<unsigned>(strtoul(argument.c_str(), nullptr, 10));
+    }
+
+    if ((cmdLine.find("--runs", index) || cmdLine.find("-n", index)) &&
+        cmdLine.get(index + 1, argument))
+    {
+        runs = std::max(1U, static_cast<unsigned>(strtoul(argument.c_str(), nullptr, 10)));
+    }
+
+    // The report goes to stdout, so keep the parser log off it
+    isp::Log::ReportingLevel() = static_cast<tLogLevel>(ERROR + 1);
+
+    std::cerr << "Default kernel: "
+              << isp::HexDecoder::getName(isp::HexDecoder::getKernel()) << std::endl;
+
+    for (unsigned megabytes : sizes)
+    {
+        if (only && only != megabytes)
+            continue;
+
+        if (!runSize(megabytes, runs))
+            returnCode = 1;
+    }
+    return returnCode;
+}
@@ -0,0 +1,381 @@
+///
+/// @file   HexDecoder.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include "HexDecoder.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEX_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HEX_NEON
+#endif
+
+
+//  Type definitions
+typedef bool (*tKernel)(const uint8_t * pHex, size_t count, uint8_t * pOut, unsigned& sum);
+
+
+//  Static variables
+//  Value of each hex digit, upper or lower case; 0xFF for anything else
+static const uint8_t sNibbles[ 256 ] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+
+//
+//  @brief      Decode a few hex digit pairs with the nibble table.
+//
+bool isp::HexDecoder::decodeScalar(const uint8_t * pHex,
+                                   size_t count,
+                                   uint8_t * pOut,
+                                   unsigned& sum)
+{
+    uint8_t invalid = 0U;
+
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+        uint8_t high = sNibbles[ pHex[ 2 * ii ] ];
+        uint8_t low  = sNibbles[ pHex[ 2 * ii + 1 ] ];
+
+        // Any bad digit leaves its high bits set
+        invalid |= (high | low);
+        pOut[ ii ] = static_cast<uint8_t>((high << 4) | low);
+        sum += pOut[ ii ];
+    }
+    return (invalid & 0xF0) == 0;
+}
+
+
+#if defined(HEX_X86)
+//
+//  @brief      Convert 16 hex digits to nibbles with SSE2.
+//
+//  @details    Digits are taken from the character as is, letters from the
+//              character folded to lower case, so that nothing else folds
+//              into a digit.  Lanes that are neither are marked invalid.
+//
+__attribute__((target("sse2")))
+static inline __m128i nibblesSSE2(__m128i chars, __m128i& invalid)
+{
+    __m128i digit   = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i alpha   = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                   _mm_set1_epi8('a'));
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+    invalid = _mm_or_si128(invalid,
+                           _mm_andnot_si128(_mm_or_si128(isDigit, isAlpha),
+                                            _mm_set1_epi8(-1)));
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+
+//
+//  @brief      Join nibble pairs into the low byte of each 16-bit lane.
+//
+__attribute__((target("sse2")))
+static inline __m128i joinSSE2(__m128i nibbles)
+{
+    // Little endian: the first digit of each pair is the low byte
+    return _mm_or_si128(_mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00F0)),
+                        _mm_srli_epi16(nibbles, 8));
+}
+
+
+//
+//  @brief      Decode hex digit pairs with SSE2.
+//
+__attribute__((target("sse2")))
+static bool decodeSSE2(const uint8_t * pHex,
+                       size_t count,
+                       uint8_t * pOut,
+                       unsigned& sum)
+{
+    __m128i invalid = _mm_setzero_si128();
+    __m128i total = _mm_setzero_si128();
+    size_t  ii = 0;
+
+    for (; ii + 16 <= count; ii += 16)
+    {
+        const __m128i * pIn = reinterpret_cast<const __m128i *>(pHex + 2 * ii);
+        __m128i first  = joinSSE2(nibblesSSE2(_mm_loadu_si128(pIn), invalid));
+        __m128i second = joinSSE2(nibblesSSE2(_mm_loadu_si128(pIn + 1), invalid));
+        __m128i bytes  = _mm_packus_epi16(first, second);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut + ii), bytes);
+        total = _mm_add_epi64(total, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+    }
+
+    sum += static_cast<unsigned>(_mm_cvtsi128_si32(total)) +
+           static_cast<unsigned>(_mm_cvtsi128_si32(_mm_srli_si128(total, 8)));
+
+    return (_mm_movemask_epi8(invalid) == 0) &&
+           isp::HexDecoder::decodeScalar(pHex + 2 * ii, count - ii, pOut + ii, sum);
+}
+
+
+//
+//  @brief      Convert 32 hex digits to nibbles with AVX2.
+//
+__attribute__((target("avx2")))
+static inline __m256i nibblesAVX2(__m256i chars, __m256i& invalid)
+{
+    __m256i digit   = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i alpha   = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)),
+                                      _mm256_set1_epi8('a'));
+    __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+
+    invalid = _mm256_or_si256(invalid,
+                              _mm256_andnot_si256(_mm256_or_si256(isDigit, isAlpha),
+                                                  _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                           _mm256_and_si256(isAlpha,
+                                            _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+
+//
+//  @brief      Join nibble pairs into the low byte of each 16-bit lane.
+//
+__attribute__((target("avx2")))
+static inline __m256i joinAVX2(__m256i nibbles)
+{
+    return _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(nibbles, 4),
+                                            _mm256_set1_epi16(0x00F0)),
+                           _mm256_srli_epi16(nibbles, 8));
+}
+
+
+//
+//  @brief      Decode hex digit pairs with AVX2.
+//
+__attribute__((target("avx2")))
+static bool decodeAVX2(const uint8_t * pHex,
+                       size_t count,
+                       uint8_t * pOut,
+                       unsigned& sum)
+{
+    __m256i invalid = _mm256_setzero_si256();
+    __m256i total = _mm256_setzero_si256();
+    size_t  ii = 0;
+
+    for (; ii + 32 <= count; ii += 32)
+    {
+        const __m256i * pIn = reinterpret_cast<const __m256i *>(pHex + 2 * ii);
+        __m256i first  = joinAVX2(nibblesAVX2(_mm256_loadu_si256(pIn), invalid));
+        __m256i second = joinAVX2(nibblesAVX2(_mm256_loadu_si256(pIn + 1), invalid));
+
+        // The pack works within each 128-bit half, so put the quarters back
+        // in order
+        __m256i bytes  = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(pOut + ii), bytes);
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(total),
+                                 _mm256_extracti128_si256(total, 1));
+
+    sum += static_cast<unsigned>(_mm_cvtsi128_si32(half)) +
+           static_cast<unsigned>(_mm_cvtsi128_si32(_mm_srli_si128(half, 8)));
+
+    return (_mm256_movemask_epi8(invalid) == 0) &&
+           decodeSSE2(pHex + 2 * ii, count - ii, pOut + ii, sum);
+}
+#endif
+
+
+#if defined(HEX_NEON)
+//
+//  @brief      Convert 16 hex digits to nibbles with NEON.
+//
+static inline uint8x16_t nibblesNEON(uint8x16_t chars, uint8x16_t& invalid)
+{
+    uint8x16_t digit   = vsubq_u8(chars, vdupq_n_u8('0'));
+    uint8x16_t alpha   = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t isDigit = vcleq_u8(digit, vdupq_n_u8(9));
+    uint8x16_t isAlpha = vcleq_u8(alpha, vdupq_n_u8(5));
+
+    invalid = vorrq_u8(invalid, vmvnq_u8(vorrq_u8(isDigit, isAlpha)));
+    return vbslq_u8(isDigit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+}
+
+
+//
+//  @brief      Decode hex digit pairs with NEON.
+//
+static bool decodeNEON(const uint8_t * pHex,
+                       size_t count,
+                       uint8_t * pOut,
+                       unsigned& sum)
+{
+    uint8x16_t invalid = vdupq_n_u8(0);
+    uint32x4_t total = vdupq_n_u32(0);
+    size_t     ii = 0;
+
+    for (; ii + 16 <= count; ii += 16)
+    {
+        // The load splits the pairs into first and second digits
+        uint8x16x2_t chars = vld2q_u8(pHex + 2 * ii);
+        uint8x16_t   high  = nibblesNEON(chars.val[ 0 ], invalid);
+        uint8x16_t   low   = nibblesNEON(chars.val[ 1 ], invalid);
+        uint8x16_t   bytes = vorrq_u8(vshlq_n_u8(high, 4), low);
+
+        vst1q_u8(pOut + ii, bytes);
+        total = vpadalq_u16(total, vpaddlq_u8(bytes));
+    }
+
+    uint64x2_t wide = vpaddlq_u32(total);
+    uint64x2_t bad  = vreinterpretq_u64_u8(invalid);
+
+    sum += static_cast<unsigned>(vgetq_lane_u64(wide, 0) + vgetq_lane_u64(wide, 1));
+
+    return ((vgetq_lane_u64(bad, 0) | vgetq_lane_u64(bad, 1)) == 0) &&
+           isp::HexDecoder::decodeScalar(pHex + 2 * ii, count - ii, pOut + ii, sum);
+}
+#endif
+
+
+//
+//  @brief      Get the kernel function.
+//
+static tKernel getFunction(isp::HexDecoder::Kernel kernel)
+{
+    switch (kernel)
+    {
+#if defined(HEX_X86)
+    case isp::HexDecoder::KERNEL_SSE2:
+        return decodeSSE2;
+    case isp::HexDecoder::KERNEL_AVX2:
+        return decodeAVX2;
+#endif
+#if defined(HEX_NEON)
+    case isp::HexDecoder::KERNEL_NEON:
+        return decodeNEON;
+#endif
+    case isp::HexDecoder::KERNEL_SCALAR:
+        return isp::HexDecoder::decodeScalar;
+    default:
+        return nullptr;
+    }
+}
+
+
+//
+//  @brief      Choose the fastest supported kernel.
+//
+static isp::HexDecoder::Kernel chooseKernel()
+{
+    // Records carry 16 or 32 bytes, too short for AVX2 to pay for itself;
+    // isp15xx-hexbench shows SSE2 ahead on both
+    const isp::HexDecoder::Kernel order[] =
+    {
+        isp::HexDecoder::KERNEL_NEON,
+        isp::HexDecoder::KERNEL_SSE2,
+        isp::HexDecoder::KERNEL_AVX2
+    };
+
+    for (isp::HexDecoder::Kernel kernel : order)
+    {
+        if (isp::HexDecoder::isSupported(kernel))
+            return kernel;
+    }
+    return isp::HexDecoder::KERNEL_SCALAR;
+}
+
+
+//  Static variables
+static isp::HexDecoder::Kernel sKernel = chooseKernel();
+static tKernel spDecode = getFunction(sKernel);
+
+
+//
+//  @brief      Decode hex digit pairs into bytes.
+//
+bool isp::HexDecoder::decode(const uint8_t * pHex,
+                             size_t count,
+                             uint8_t * pOut,
+                             unsigned& sum)
+{
+    return spDecode(pHex, count, pOut, sum);
+}
+
+
+//
+//  @brief      Determine if a kernel can run on this processor.
+//
+bool isp::HexDecoder::isSupported(isp::HexDecoder::Kernel kernel)
+{
+    if (!getFunction(kernel))
+        return false;
+
+#if defined(HEX_X86)
+    __builtin_cpu_init();
+    if (kernel == KERNEL_SSE2)
+        return __builtin_cpu_supports("sse2");
+    if (kernel == KERNEL_AVX2)
+        return __builtin_cpu_supports("avx2");
+#endif
+    return true;
+}
+
+
+//
+//  @brief      Select the kernel used by decode.
+//
+bool isp::HexDecoder::setKernel(isp::HexDecoder::Kernel kernel)
+{
+    if (!isSupported(kernel))
+        return false;
+
+    sKernel  = kernel;
+    spDecode = getFunction(kernel);
+    return true;
+}
+
+
+//
+//  @brief      Get the selected kernel.
+//
+isp::HexDecoder::Kernel isp::HexDecoder::getKernel()
+{
+    return sKernel;
+}
+
+
+//
+//  @brief      Get the name of a kernel.
+//
+const char * isp::HexDecoder::getName(isp::HexDecoder::Kernel kernel)
+{
+    static const char * const names[ KERNEL_COUNT ] =
+    {
+        "scalar", "sse2", "avx2", "neon"
+    };
+
+    return (kernel < KERNEL_COUNT)? names[ kernel ]: "unknown";
+}
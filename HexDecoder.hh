@@ -0,0 +1,133 @@
+///
+/// @file   HexDecoder.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef HEXDECODER_HH_
+#define HEXDECODER_HH_
+
+//  Includes
+#include <stdint.h>
+#include <stddef.h>
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Hex digit pair decoder for Intel Hex data records.
+///
+/// @details    Converts pairs of hex digits to bytes, adding each byte to a
+///             running sum for the record checksum.  Vector kernels are
+///             used where the processor has them, chosen once at start-up;
+///             a table-driven scalar kernel handles everything else and the
+///             tail of each run.  The AVX2 kernel is built for comparison
+///             but is not the default.
+///
+class HexDecoder
+{
+public:
+    typedef enum {
+        KERNEL_SCALAR,          ///< 256-entry nibble table
+        KERNEL_SSE2,            ///< x86 SSE2, 16 bytes at a time
+        KERNEL_AVX2,            ///< x86 AVX2, 32 bytes at a time
+        KERNEL_NEON,            ///< ARM NEON, 16 bytes at a time
+        KERNEL_COUNT
+    } Kernel;
+
+    ///
+    /// @brief      Decode hex digit pairs into bytes.
+    ///
+    /// @param[in]  pHex
+    ///             The hex digits, upper or lower case.
+    ///
+    /// @param[in]  count
+    ///             The number of bytes to decode; twice as many digits.
+    ///
+    /// @param[out] pOut
+    ///             The buffer for the bytes.
+    ///
+    /// @param[in,out] sum
+    ///             The running sum; each byte is added to it.
+    ///
+    /// @return     Boolean false if any character is not a hex digit.
+    ///
+    static bool decode(const uint8_t * pHex,
+                       size_t count,
+                       uint8_t * pOut,
+                       unsigned& sum);
+
+    ///
+    /// @brief      Decode a few hex digit pairs with the nibble table.
+    ///
+    /// @details    For the fixed fields of a record, which are too short
+    ///             for a vector kernel to be worth the call.
+    ///
+    /// @param[in]  pHex
+    ///             The hex digits, upper or lower case.
+    ///
+    /// @param[in]  count
+    ///             The number of bytes to decode.
+    ///
+    /// @param[out] pOut
+    ///             The buffer for the bytes.
+    ///
+    /// @param[in,out] sum
+    ///             The running sum; each byte is added to it.
+    ///
+    /// @return     Boolean false if any character is not a hex digit.
+    ///
+    static bool decodeScalar(const uint8_t * pHex,
+                             size_t count,
+                             uint8_t * pOut,
+                             unsigned& sum);
+
+    ///
+    /// @brief      Determine if a kernel can run on this processor.
+    ///
+    /// @param[in]  kernel
+    ///             The kernel.
+    ///
+    /// @return     Boolean true if the kernel is built in and supported.
+    ///
+    static bool isSupported(Kernel kernel);
+
+    ///
+    /// @brief      Select the kernel used by decode.
+    ///
+    /// @details    For comparing kernels; NEON or SSE2 is selected at
+    ///             start-up where supported.
+    ///
+    /// @param[in]  kernel
+    ///             The kernel.
+    ///
+    /// @return     Boolean false if the kernel is not supported.
+    ///
+    static bool setKernel(Kernel kernel);
+
+    ///
+    /// @brief      Get the selected kernel.
+    ///
+    /// @return     The kernel used by decode.
+    ///
+    static Kernel getKernel();
+
+    ///
+    /// @brief      Get the name of a kernel.
+    ///
+    /// @param[in]  kernel
+    ///             The kernel.
+    ///
+    /// @return     The name of the kernel.
+    ///
+    static const char * getName(Kernel kernel);
+
+private:
+    HexDecoder() = delete;
+    HexDecoder(const HexDecoder& ref) = delete;
+    HexDecoder& operator = (const HexDecoder& ref) = delete;
+};  // class
+
+} // namespace
+#endif
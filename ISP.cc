@@ -6,18 +6,30 @@
 ///
 
 //  Includes
+#include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 #include <iostream>
 #include <iomanip>
+#include "Gpio.hh"
 #include "ISP.hh"
 #include "Log.hh"
 #include "Utility.hh"
 
 
 //  Definitions
-#define RESET   "/sys/class/gpio/gpio17/value"
-#define ISP0    "/sys/class/gpio/gpio18/value"
-#define ISP1    "/sys/class/gpio/gpio27/value"
+//  Bytes of flash checksummed by a link probe
+#define PROBE_SIZE  (256U)
+
+//  Bytes on the wire allowed for one '?' and its "Synchronized\r\n"
+//  answer, with room for the answer to start late
+#define PROBE_BYTES     (32U)
+
+//  Milliseconds allowed for a USB adapter to pass on the answer
+#define PROBE_LATENCY   (2U)
+
+//  Longest command line, with its CR-LF and terminator
+#define COMMAND_SIZE    (64U)
 
 
 //  External References
@@ -26,6 +38,29 @@ extern  bool    gIsVerbose;
 extern  bool    gNoGPIO;
 
 
+//  Static variables
+//  Standard rates offered to the target, fastest first
+static const unsigned sBaudRates[] =
+{
+    921600, 460800, 230400, 115200, 57600, 38400, 19200, 9600
+};
+
+static const size_t sBaudCount = sizeof(sBaudRates) / sizeof(sBaudRates[0]);
+
+
+//
+//  @brief      Get the milliseconds elapsed since a monotonic time stamp.
+//
+static unsigned elapsedMS(const struct timespec& start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<unsigned>((now.tv_sec - start.tv_sec) * 1000 +
+                                 (now.tv_nsec - start.tv_nsec) / 1000000);
+}
+
+
 ///
 /// @brief      Explicit constructor for the ISP class.
 ///
@@ -35,7 +70,8 @@ isp::ISP::ISP(isp::Serial& serial,
         : mSerial(serial),
           mIsActiveLowReset(isActiveLowReset),
           mIsVerbose(isVerbose),
-          mIsEcho(true)
+          mIsEcho(true),
+          mIsPipeline(false)
 {}
 
 
@@ -46,36 +82,7 @@ void isp::ISP::programMode()
 {
     if (gNoGPIO == false)
     {
-        int rst  = isp::ISP::hwSignalOpen(RESET);
-        int isp0 = isp::ISP::hwSignalOpen(ISP0);
-        int isp1 = isp::ISP::hwSignalOpen(ISP1);
-
-        // Assert ISP0,1 at LOW (Serial ISP )
-        hwSignalSet(isp0, ISP0, false);
-        hwSignalSet(isp1, ISP1, false);
-        usleep(100 * 1000);
-
-        // Assert reset active
-        if (mIsActiveLowReset)
-            hwSignalSet(rst, RESET, false);
-        else
-            hwSignalSet(rst, RESET, true);
-        usleep(500 * 1000);
-
-        // deassert reset inactive
-        if (mIsActiveLowReset)
-            hwSignalSet(rst, RESET, true);
-        else
-            hwSignalSet(rst, RESET, false);
-        usleep(100 * 1000);
-
-        // Assert ISP0,1 at HIGH
-        hwSignalSet(isp0, ISP0, false);
-        hwSignalSet(isp1, ISP1, false);
-
-        isp::ISP::hwSignalClose(rst, RESET);
-        isp::ISP::hwSignalClose(isp0, ISP0);
-        isp::ISP::hwSignalClose(isp1, ISP1);
+        isp::Gpio::getInstance().enterISP(mIsActiveLowReset);
     }
     else
     {
@@ -93,36 +100,7 @@ void isp::ISP::applicationMode()
 {
     if (gNoGPIO == false)
     {
-        int rst  = isp::ISP::hwSignalOpen(RESET);
-        int isp0 = isp::ISP::hwSignalOpen(ISP0);
-        int isp1 = isp::ISP::hwSignalOpen(ISP1);
-
-        // Assert ISP0,1 at HIGH (Application mode )
-        hwSignalSet(isp0, ISP0, true);
-        hwSignalSet(isp1, ISP1, true);
-        usleep(100 * 1000);
-
-        // Assert reset at LOW
-        if (mIsActiveLowReset)
-            hwSignalSet(rst, RESET, false);
-        else
-            hwSignalSet(rst, RESET, true);
-        usleep(500 * 1000);
-
-        // deassert reset at HIGH
-        if (mIsActiveLowReset)
-            hwSignalSet(rst, RESET, true);
-        else
-            hwSignalSet(rst, RESET, false);
-        usleep(100 * 1000);
-
-        // Assert ISP0,1 at HIGH
-        hwSignalSet(isp0, ISP0, true);
-        hwSignalSet(isp1, ISP1, true);
-
-        isp::ISP::hwSignalClose(rst, RESET);
-        isp::ISP::hwSignalClose(isp0, ISP0);
-        isp::ISP::hwSignalClose(isp1, ISP1);
+        isp::Gpio::getInstance().enterApplication(mIsActiveLowReset);
     }
     else
     {
@@ -143,73 +121,178 @@ isp::ISP::Error isp::ISP::synchronize(bool isVerbose)
 
     do
     {
-        ssize_t bytesRead = 0;
-
         if (gQuit == true)
             break;
 
         // First, clear out any residual read bytes
-        if (mSerial.isOpen())
-        {
-            std::string nothing;
-            unsigned readTime = 0U;
+        mSerial.flush();
+
+        // Probe until the bootloader answers or the boot time of the
+        // fixture runs out, rather than sleeping for the worst case
+        if ((errorCode = probe(isp::Gpio::getProfile().bootMS, isVerbose)))
+            break;
+
+        errorCode = handshake(isVerbose);
+    } while (false);
+
+    return errorCode;
+}
 
-            mSerial.read(nothing, isp::ISP::MEDIUM_TIMEOUT, readTime);
+
+//
+//  @brief      Synchronize to a target already in ISP mode.
+//
+isp::ISP::Error isp::ISP::detect(bool isVerbose)
+{
+    Error errorCode = ERR_ISP_TIMEOUT;
+
+    do
+    {
+        if (gQuit == true)
+            break;
+
+        mSerial.flush();
+
+        // A bootloader still waiting for autobaud answers a single probe
+        if (probe(0U, isVerbose) == ERR_ISP_NO_ERROR)
+        {
+            errorCode = handshake(isVerbose);
+            break;
         }
 
-        // Send out the query '?' and attempt to synchronize
+        // One already synchronized takes the '?' as the start of a command
+        // line, so ending the line draws an INVALID_COMMAND status
         {
-            const char query[2] = "?";
+            std::string command = "\r\n";
+            std::string test = "1\r\n";
             std::string answer;
-            std::string test = "Synchronized\r\n";
 
-            bytesRead = send(query, answer, test, 10, isVerbose);
-            if (answer.find("Synchronized") != std::string::npos)
-            {
-                std::string tmp = "OK";
+            ssize_t bytesRead = send(command, answer, test, contains(test),
+                                     getProbeInterval(), isVerbose, 1);
+            if (bytesRead <= 0)
+                break;
 
-                bytesRead = send(test, answer, tmp, 20);
-                if ((bytesRead == 0) || answer.find("OK") == std::string::npos)
-                    break;
-            }
-            else
-            {
+            // With echo on the end of the line comes back before the status
+            mIsEcho = (answer.find("\r\n" + test) != std::string::npos);
+        }
+
+        errorCode = identify(isVerbose);
+    } while (false);
+
+    if (errorCode == ERR_ISP_NO_ERROR)
+        LOG(INFO) << "Target already in ISP mode";
+    return errorCode;
+}
+
+
+//
+//  @brief      Send '?' until the bootloader answers.
+//
+isp::ISP::Error isp::ISP::probe(unsigned timeoutInMS, bool isVerbose)
+{
+    const char query[2] = "?";
+    std::string answer;
+    std::string test = "Synchronized\r\n";
+    unsigned interval = getProbeInterval();
+    struct timespec start;
+    ssize_t bytesRead = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do
+    {
+        mMetrics.count(isp::Metrics::COUNTER_SYNC_PROBES);
+        bytesRead = send(query, answer, test, contains(test), interval, isVerbose, 1);
+    } while (bytesRead <= 0 && gQuit == false &&
+             elapsedMS(start) < timeoutInMS);
+
+    if (bytesRead <= 0)
+        return ERR_ISP_TIMEOUT;
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    mMetrics.count(isp::Metrics::COUNTER_SYNC_LATENCY,
+                   (now.tv_sec - start.tv_sec) * 1000000 +
+                   (now.tv_nsec - start.tv_nsec) / 1000);
+    return ERR_ISP_NO_ERROR;
+}
+
+
+//
+//  @brief      Finish synchronization after the bootloader answered.
+//
+isp::ISP::Error isp::ISP::handshake(bool isVerbose)
+{
+    Error errorCode = ERR_ISP_TIMEOUT;
+
+    do
+    {
+        ssize_t bytesRead = 0;
+
+        // Echo "Synchronized" and wait for the "OK"
+        {
+            std::string command = "Synchronized\r\n";
+            std::string test = "OK\r\n";
+            std::string answer;
+
+            bytesRead = send(command, answer, test, contains(test),
+                             SHORT_TIMEOUT, isVerbose);
+            if (bytesRead <= 0)
                 break;
-            }
         }
 
+        // The bootloader starts with echo on after autobaud
+        mIsEcho = true;
+
         // Send out ESC
         {
             const char esc[2] = { 0x27, 0 };
             std::string answer;
 
-            bytesRead = send(esc, answer, 10, isVerbose);
+            bytesRead = send(esc, answer, isp::Serial::bytes(1),
+                             MINIMAL_TIMEOUT, isVerbose);
             if ((bytesRead == 0) || answer.find(esc) == std::string::npos)
                 break;
         }
 
-        // Do an ID query
-        {
-            std::string command = "J\r\n";
-            std::string test = (mIsEcho? command + "0\r\n": "0\r\n");
-            std::string answer;
+        errorCode = identify(isVerbose);
+    } while (false);
 
-            bytesRead = send(command, answer, test, 20, isVerbose);
-            size_t pos = answer.find(test);
+    return errorCode;
+}
 
-            if ((bytesRead > 0) && (pos != std::string::npos))
-            {
-                errorCode = ERR_ISP_NO_ERROR;
-                std::string tmp = answer.substr(pos + test.length());
-                mChipId = isp::Utility::trim(tmp);
-            }
-        }
-    } while (false);
 
+//
+//  @brief      Confirm the link with an ID query.
+//
+isp::ISP::Error isp::ISP::identify(bool isVerbose)
+{
+    const char command[] = "J\r\n";
+    isp::Response response(1U);
+    Error errorCode = transact(command, sizeof(command) - 1, response,
+                               SHORT_TIMEOUT, isVerbose);
+
+    if (errorCode == ERR_ISP_NO_ERROR)
+        mChipId = std::to_string(response.getField(0));
     return errorCode;
 }
 
 
+//
+//  @brief      Get the time to wait for the answer to one probe.
+//
+unsigned isp::ISP::getProbeInterval()
+{
+    unsigned baud = mSerial.getBaudRate();
+
+    if (baud == 0U)
+        return MINIMAL_TIMEOUT;
+
+    // The probe and its answer on the wire, rounded up, plus the adapter
+    return (PROBE_BYTES * 10U * 1000U + baud - 1U) / baud + PROBE_LATENCY;
+}
+
+
 //
 //  @brief      Set the baud rate and number of stop bits
 //              for the target.
@@ -226,33 +309,126 @@ isp::ISP::Error isp::ISP::setBaudRate(unsigned baud,
         if (gQuit == true)
             break;
 
-        std::string command = "B " + std::to_string(baud) + " " + std::to_string(stopBits) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "B %u %u\r\n", baud, stopBits);
+        isp::Response response;
 
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR)
+        {
+            LOG(INFO) << "Baud rate set to "
+                      << baud
+                      << " and number of stop bits is "
+                      << stopBits;
+        }
+
+    } while (false);
+
+    return errorCode;
+}
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+
+//
+//  @brief      Negotiate the fastest baud rate the link will carry.
+//
+isp::ISP::Error isp::ISP::negotiateBaudRate(unsigned maxBaud,
+                                            unsigned timeoutInMS,
+                                            bool isVerbose)
+{
+    Error errorCode = ERR_ISP_NO_ERROR;
+
+    for (size_t ii = 0; ii < sBaudCount; ++ii)
+    {
+        unsigned baud = sBaudRates[ ii ];
+
+        if (gQuit == true)
+            break;
+
+        if ((baud > maxBaud) || !isp::Serial::isBaudRate(baud))
+            continue;
+
+        // Nothing faster than the current rate worked
+        if (baud == mSerial.getBaudRate())
+            break;
+
+        if (changeBaudRate(baud, timeoutInMS, isVerbose) == ERR_ISP_NO_ERROR)
+            break;
+
+        // The link must still work at the old rate to try the next one
+        if ((errorCode = probeLink(timeoutInMS)))
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
+            LOG(ERROR) << "Link lost while negotiating the baud rate";
+            break;
+        }
+    }
 
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
+    LOG(INFO) << "Link running at " << std::dec << mSerial.getBaudRate() << " baud";
+    return errorCode;
+}
 
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                LOG(INFO) << "Baud rate set to "
-                          << baud
-                          << " and number of stop bits is "
-                          << stopBits;
-            }
+
+//
+//  @brief      Drop the link to the next slower baud rate.
+//
+isp::ISP::Error isp::ISP::fallbackBaudRate(unsigned timeoutInMS,
+                                           bool isVerbose)
+{
+    Error errorCode = ERR_ISP_INVALID_BAUD_RATE;
+
+    // A cancelled wait is not a link fault
+    if (gQuit == true || isp::Serial::isCancelled())
+        return ERR_ISP_TIMEOUT;
+
+    for (size_t ii = 0; ii < sBaudCount; ++ii)
+    {
+        unsigned baud = sBaudRates[ ii ];
+
+        if ((baud >= mSerial.getBaudRate()) || !isp::Serial::isBaudRate(baud))
+            continue;
+
+        LOG(WARNING) << "Falling back from " << std::dec << mSerial.getBaudRate()
+                     << " to " << baud << " baud";
+        errorCode = changeBaudRate(baud, timeoutInMS, isVerbose);
+        break;
+    }
+    return errorCode;
+}
+
+
+//
+//  @brief      Move both ends of the link to a new baud rate.
+//
+isp::ISP::Error isp::ISP::changeBaudRate(unsigned baud,
+                                         unsigned timeoutInMS,
+                                         bool isVerbose)
+{
+    Error errorCode = ERR_ISP_NO_ERROR;
+    unsigned previous = mSerial.getBaudRate();
+
+    do
+    {
+        // The target answers at the old rate and then switches
+        if ((errorCode = setBaudRate(baud, 1, timeoutInMS, isVerbose)))
+        {
+            LOG(INFO) << "Target refused " << std::dec << baud << " baud: " << errorCode;
+            break;
+        }
+
+        if (!mSerial.setBaudRate(baud))
+        {
+            LOG(WARNING) << "Serial adapter refused " << std::dec << baud << " baud";
+            errorCode = ERR_ISP_INVALID_BAUD_RATE;
         }
+        else if ((errorCode = probeLink(timeoutInMS)) == ERR_ISP_NO_ERROR)
+        {
+            break;
+        }
+
+        // Ask the target to go back; the command often still gets through
+        // at a marginal rate
+        LOG(WARNING) << "Link probe failed at " << std::dec << baud << " baud";
+        setBaudRate(previous, 1, timeoutInMS, isVerbose);
+        mSerial.setBaudRate(previous);
 
     } while (false);
 
@@ -260,6 +436,25 @@ isp::ISP::Error isp::ISP::setBaudRate(unsigned baud,
 }
 
 
+//
+//  @brief      Confirm the link carries commands at the current rate.
+//
+isp::ISP::Error isp::ISP::probeLink(unsigned timeoutInMS)
+{
+    uint32_t first = 0U;
+    uint32_t second = 0U;
+    Error errorCode = queryCRC(0U, PROBE_SIZE, first, timeoutInMS);
+
+    if (errorCode == ERR_ISP_NO_ERROR)
+        errorCode = queryCRC(0U, PROBE_SIZE, second, timeoutInMS);
+
+    if ((errorCode == ERR_ISP_NO_ERROR) && (first != second))
+        errorCode = ERR_ISP_COMPARE_ERROR;
+
+    return errorCode;
+}
+
+
 //
 //  @brief      Get the chip identifier for the target.
 //
@@ -274,31 +469,15 @@ isp::ISP::Error isp::ISP::queryId(uint32_t& chipId,
         if (gQuit == true)
             break;
 
-        std::string command = "J\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
-
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        const char command[] = "J\r\n";
+        isp::Response response(1U);
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, sizeof(command) - 1, response,
+                             timeoutInMS, isVerbose);
+        if ((errorCode == ERR_ISP_NO_ERROR) && (response.getFieldCount() > 0))
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if ((errorCode == ERR_ISP_NO_ERROR) && (results.size() > 1))
-            {
-                chipId = static_cast<uint32_t>(
-                                    isp::Utility::stringToInt(results[1]));
-                LOG(INFO) << "Device is 0x" << std::hex << chipId;
-            }
+            chipId = response.getField(0);
+            LOG(INFO) << "Device is 0x" << std::hex << chipId;
         }
 
     } while (false);
@@ -322,34 +501,18 @@ isp::ISP::Error isp::ISP::queryUID(std::vector<std::string>& vec,
             break;
 
         // Unique ID
-        std::string command = "N\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
-
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        const char command[] = "N\r\n";
+        isp::Response response(4U);
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, sizeof(command) - 1, response,
+                             timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
+            vec.clear();
+            for (unsigned ii = 0; ii < response.getFieldCount(); ++ii)
             {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                results.erase(results.begin());
-                results.erase(results.end());
-                vec = results;
-
-                unsigned ii = 0;
-                for (std::string& s : vec)
-                    LOG(INFO) << "UID[" << ii++ << "] is " << s;
+                vec.push_back(std::to_string(response.getField(ii)));
+                LOG(INFO) << "UID[" << ii << "] is " << vec.back();
             }
         }
 
@@ -374,33 +537,18 @@ isp::ISP::Error isp::ISP::queryBootloaderVersion(std::vector<std::string>& vec,
             break;
 
         // Bootloader version
-        std::string command = "K\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
+        const char command[] = "K\r\n";
+        isp::Response response(2U);
 
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
-
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, sizeof(command) - 1, response,
+                             timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
+            vec.clear();
+            for (unsigned ii = 0; ii < response.getFieldCount(); ++ii)
             {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                results.erase(results.begin());
-                results.erase(results.end());
-                vec = results;
-
-                for (std::string& s : vec)
-                    LOG(INFO) << "version: " << s;
+                vec.push_back(std::to_string(response.getField(ii)));
+                LOG(INFO) << "version: " << vec.back();
             }
         }
 
@@ -427,31 +575,17 @@ isp::ISP::Error isp::ISP::queryCRC(uint32_t address,
         if (gQuit == true)
             break;
 
-        std::string command = "S " + std::to_string(address) + " " + std::to_string(size) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
-
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "S %u %u\r\n",
+                              address, static_cast<unsigned>(size));
+        isp::Response response(1U);
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        if ((errorCode == ERR_ISP_NO_ERROR) && (response.getFieldCount() > 0))
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if ((errorCode == 0) && (results.size() > 1))
-            {
-                crc = static_cast<uint32_t>(
-                        isp::Utility::stringToInt(results[1]));
+            crc = response.getField(0);
+            if (isVerbose)
                 LOG(INFO) << "Checksum is 0x" << std::hex << crc;
-            }
         }
 
         if (errorCode != isp::ISP::ERR_ISP_NO_ERROR)
@@ -482,30 +616,16 @@ isp::ISP::Error isp::ISP::unlockFlash(unsigned timeoutInMS,
             break;
 
         // Unlock flash
-        std::string command = "U 23130\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
+        const char command[] = "U 23130\r\n";
+        isp::Response response;
 
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
-
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, sizeof(command) - 1, response,
+                             timeoutInMS, isVerbose);
+        if (errorCode != ERR_ISP_NO_ERROR)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-            else
-            {
-                LOG(ERROR) << "Error "
-                           << errorCode
-                           << " in unlocking flash";
-            }
+            LOG(ERROR) << "Error "
+                       << errorCode
+                       << " in unlocking flash";
         }
 
     } while (false);
@@ -530,44 +650,29 @@ isp::ISP::Error isp::ISP::prepareSectors(unsigned start,
             break;
 
         // Prepare sectors
-        std::string command = "P " + std::to_string(start) + " " + std::to_string(end) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "P %u %u\r\n", start, end);
+        isp::Response response;
 
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
-
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR && isVerbose)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR && isVerbose)
+            if (start == end)
             {
-                if (start == end)
-                {
-                    LOG(INFO) << "Sector " << start << " is prepared for write operations";
-                }
-                else
-                {
-                    LOG(INFO) << "Sectors " << start << " to " << end << " prepared for write operations";
-                }
+                LOG(INFO) << "Sector " << start << " is prepared for write operations";
             }
             else
             {
-                if (isVerbose)
-                    LOG(ERROR) << "Error: "
-                               << errorCode
-                               << " preparing sectors for write";
+                LOG(INFO) << "Sectors " << start << " to " << end << " prepared for write operations";
             }
         }
+        else
+        {
+            if (isVerbose)
+                LOG(ERROR) << "Error: "
+                           << errorCode
+                           << " preparing sectors for write";
+        }
 
     } while (false);
 
@@ -591,44 +696,29 @@ isp::ISP::Error isp::ISP::eraseSectors(unsigned start,
             break;
 
         // Erase sectors
-        std::string command = "E " + std::to_string(start) + " " + std::to_string(end) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
-
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "E %u %u\r\n", start, end);
+        isp::Response response;
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR && isVerbose)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
+            if (start == end)
             {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR && isVerbose)
-            {
-                if (start == end)
-                {
-                    LOG(INFO) << "Sector " << start << " is erased";
-                }
-                else
-                {
-                    LOG(INFO) << "Sectors " << start << " to " << end << " erased";
-                }
+                LOG(INFO) << "Sector " << start << " is erased";
             }
             else
             {
-                if (isVerbose)
-                    LOG(ERROR) << "Error: "
-                               << errorCode
-                               << " performing sector erase";
+                LOG(INFO) << "Sectors " << start << " to " << end << " erased";
             }
         }
+        else
+        {
+            if (isVerbose)
+                LOG(ERROR) << "Error: "
+                           << errorCode
+                           << " performing sector erase";
+        }
 
     } while (false);
 
@@ -651,41 +741,27 @@ isp::ISP::Error isp::ISP::blankCheckSector(unsigned sector,
         if (gQuit == true)
             break;
 
-        // Blank check sectors
-        std::string command = "I " + std::to_string(sector) + " " + std::to_string(sector) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
+        // Blank check sectors; a sector that is not blank also reports
+        // the offset and contents of the first non-blank word
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "I %u %u\r\n", sector, sector);
+        isp::Response response(0U, 2U);
 
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
-
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                sectorMap[ sector ] = true;
-            }
-            else if(errorCode == ERR_ISP_SECTOR_NOT_BLANK)
-            {
-                sectorMap[ sector ] = false;
-            }
-            else
-            {
-                if (isVerbose)
-                    LOG(ERROR) << "Error: "
-                               << errorCode
-                               << " performing blank check";
-            }
+            sectorMap[ sector ] = true;
+        }
+        else if(errorCode == ERR_ISP_SECTOR_NOT_BLANK)
+        {
+            sectorMap[ sector ] = false;
+        }
+        else
+        {
+            if (isVerbose)
+                LOG(ERROR) << "Error: "
+                           << errorCode
+                           << " performing blank check";
         }
 
     } while (false);
@@ -702,55 +778,55 @@ isp::ISP::Error isp::ISP::readMemory(uint32_t address,
                                      std::vector<uint8_t>& vec,
                                      unsigned timeoutInMS,
                                      bool isVerbose)
+{
+    size_t bytesRead = 0U;
+
+    vec.resize(size);
+    Error errorCode = readMemory(address, size, vec.data(), bytesRead,
+                                 timeoutInMS, isVerbose);
+    vec.resize(bytesRead);
+
+    return errorCode;
+}
+
+
+//
+//  @brief      Read memory from the target device into a buffer.
+//
+isp::ISP::Error isp::ISP::readMemory(uint32_t address,
+                                     size_t size,
+                                     uint8_t * pBuffer,
+                                     size_t& bytesRead,
+                                     unsigned timeoutInMS,
+                                     bool isVerbose)
 {
     Error errorCode = ERR_ISP_TIMEOUT;
 
+    bytesRead = 0U;
+
     do
     {
         if (gQuit == true)
             break;
 
-        // Read memory
-        std::string command = "R " + std::to_string(address) + " " + std::to_string(size) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        ssize_t bytesRead = send(command, vec, test, timeoutInMS, isVerbose);
+        // The reply carries raw bytes
+        isp::Serial::BinaryScope binary(mSerial);
 
-        if (bytesRead > 0)
-        {
-            // Convert the vector to a string
-            std::string bytes = reinterpret_cast<const char *>(vec.data());
-            size_t pos = bytes.find(test);
+        // Read memory; the data is framed by its length alone
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "R %u %u\r\n",
+                              address, static_cast<unsigned>(size));
+        isp::Response response(0U, 0U, pBuffer, size);
 
-            // See if we found the command echoed
-            if (pos != std::string::npos)
-            {
-                // Erase the command portion
-                vec.erase(vec.begin(), vec.begin() + pos + test.length());
-            }
-
-            // Convert the vector to a string
-            bytes = reinterpret_cast<const char *>(vec.data());
-            pos = bytes.find("\r\n");
-
-            // If we found the termination for the error code...
-            if (pos != std::string::npos)
-            {
-                // Isolate the error code
-                std::string error = bytes.substr(0, pos);
-                errorCode = static_cast<Error>(
-                    isp::Utility::stringToInt(error));
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        bytesRead = response.getDataSize();
 
-                // Remove the error code portion from the vector
-                vec.erase(vec.begin(), vec.begin() + pos + 2);
-            }
-            else
-            {
-                errorCode = ERR_ISP_PARAM_ERROR;
-                if (isVerbose)
-                    LOG(ERROR) << "Error: "
-                               << errorCode
-                               << " readming memory";
-            }
+        if (errorCode != ERR_ISP_NO_ERROR)
+        {
+            if (isVerbose)
+                LOG(ERROR) << "Error: "
+                           << errorCode
+                           << " reading memory";
         }
 
     } while (false);
@@ -773,36 +849,21 @@ isp::ISP::Error isp::ISP::echo(bool enable,
         if (gQuit == true)
             break;
 
-        // Echo on / off
-        std::string command = (enable? "A 1\r\n" : "A 0\r\n");
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
-
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        // Echo on / off; the command itself is echoed at the old setting
+        const char * command = (enable? "A 1\r\n" : "A 0\r\n");
+        isp::Response response;
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, strlen(command), response,
+                             timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                mIsEcho = enable;
-            }
-            else
-            {
-                LOG(ERROR) << "Error "
-                           << errorCode
-                           << " in setting Echo";
-            }
+            mIsEcho = enable;
+        }
+        else
+        {
+            LOG(ERROR) << "Error "
+                       << errorCode
+                       << " in setting Echo";
         }
 
     } while (false);
@@ -828,42 +889,26 @@ isp::ISP::Error isp::ISP::copyToFlash(uint32_t flash,
             break;
 
         // Write memory
-        std::string command = "C " + std::to_string(flash)
-                            + " " + std::to_string(address) +
-                            + " " + std::to_string(size) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "C %u %u %u\r\n",
+                              flash, address, static_cast<unsigned>(size));
+        isp::Response response;
 
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
-
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                if (isVerbose)
-                    LOG(INFO) << "Program flash at 0x"
-                              << std::hex << std::setw(8) << std::setfill('0') << flash
-                              << " From RAM at 0x"
-                              << std::hex << std::setw(8) << std::setfill('0') << address
-                              << " for " << size << " bytes";
-            }
-            else
-            {
-                LOG(ERROR) << "Error: "
-                           << errorCode
-                           << " programming flash from RAM";
-            }
+            if (isVerbose)
+                LOG(INFO) << "Program flash at 0x"
+                          << std::hex << std::setw(8) << std::setfill('0') << flash
+                          << " From RAM at 0x"
+                          << std::hex << std::setw(8) << std::setfill('0') << address
+                          << " for " << size << " bytes";
+        }
+        else
+        {
+            LOG(ERROR) << "Error: "
+                       << errorCode
+                       << " programming flash from RAM";
         }
 
     } while (false);
@@ -887,38 +932,23 @@ isp::ISP::Error isp::ISP::execute(uint32_t address,
             break;
 
         // Write memory
-        std::string command = "G " + std::to_string(address) + " T\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
-
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "G %u T\r\n", address);
+        isp::Response response;
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        errorCode = transact(command, length, response, timeoutInMS, isVerbose);
+        if (errorCode == ERR_ISP_NO_ERROR)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
-
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                if (isVerbose)
-                    LOG(INFO) << "Execute from 0x"
-                              << std::hex << std::setw(8)
-                              << std::setfill('0') << address;
-            }
-            else
-            {
-                LOG(ERROR) << "Error: "
-                           << errorCode
-                           << " executing from RAM";
-            }
+            if (isVerbose)
+                LOG(INFO) << "Execute from 0x"
+                          << std::hex << std::setw(8)
+                          << std::setfill('0') << address;
+        }
+        else
+        {
+            LOG(ERROR) << "Error: "
+                       << errorCode
+                       << " executing from RAM";
         }
 
     } while (false);
@@ -943,51 +973,49 @@ isp::ISP::Error isp::ISP::writeMemory(uint32_t address,
         if (gQuit == true)
             break;
 
-        // Write memory
-        std::string command = "W " + std::to_string(address) + " " + std::to_string(size) + "\r\n";
-        std::string test = (mIsEcho? command: "");
-        std::string answer;
-
-        ssize_t bytesRead = send(command, answer, test, timeoutInMS, isVerbose);
-        size_t pos = answer.find(test);
+        // The data goes out as raw bytes
+        isp::Serial::BinaryScope binary(mSerial);
 
-        if ((bytesRead > 0) && (pos != std::string::npos))
+        // Write memory
+        char command[ COMMAND_SIZE ];
+        int length = snprintf(command, sizeof(command), "W %u %u\r\n",
+                              address, static_cast<unsigned>(size));
+        isp::Response response;
+
+        // Without echo the data can follow the command in the same write,
+        // saving a round trip; the target buffers it while it answers
+        if (mIsPipeline && !mIsEcho)
         {
-            std::string tmp = answer.substr(pos + test.length());
-            std::vector<std::string> results;
-
-            isp::Utility::split(tmp, "\r\n", results);
-            if (results.size() > 0)
-            {
-                errorCode = static_cast<Error>(
-                        isp::Utility::stringToInt(results[0]));
-            }
+            errorCode = transact(command, length, response, timeoutInMS, isVerbose,
+                                 1, vec.data(), vec.size());
+        }
+        else if ((errorCode = transact(command, length, response,
+                                       timeoutInMS, isVerbose)) == ERR_ISP_NO_ERROR)
+        {
+            // Now write out the data
+            if (send(vec, isVerbose) <= 0)
+                errorCode = ERR_ISP_TIMEOUT;
+        }
 
-            if (errorCode == ERR_ISP_NO_ERROR)
-            {
-                // Now write out the data
-                bytesRead = send(vec, isVerbose);
-                if (bytesRead > 0)
-                {
-                    errorCode = ERR_ISP_NO_ERROR;
-                    if (isVerbose)
-                    {
-                        LOG(INFO) << "Wrote "
-                                  << vec.size()
-                                  << " (passed "
-                                  << size
-                                  << ") bytes to address at 0x"
-                                  << std::hex << std::setw(8) << std::setfill('0') << address;
-                    }
-                }
-            }
-            else
+        if (errorCode == ERR_ISP_NO_ERROR)
+        {
+            mMetrics.count(isp::Metrics::COUNTER_BYTES_WRITTEN, vec.size());
+            if (isVerbose)
             {
-                LOG(ERROR) << "Error: "
-                           << errorCode
-                           << " writing memory";
+                LOG(INFO) << "Wrote "
+                          << vec.size()
+                          << " (passed "
+                          << size
+                          << ") bytes to address at 0x"
+                          << std::hex << std::setw(8) << std::setfill('0') << address;
             }
         }
+        else
+        {
+            LOG(ERROR) << "Error: "
+                       << errorCode
+                       << " writing memory";
+        }
 
     } while (false);
 
@@ -1000,6 +1028,7 @@ isp::ISP::Error isp::ISP::writeMemory(uint32_t address,
 //
 ssize_t isp::ISP::send(const std::string& command,
                        std::string& response,
+                       const isp::Serial::tFrameCheck& isComplete,
                        unsigned timeoutInMS,
                        bool isVerbose,
                        int retryCount)
@@ -1014,6 +1043,9 @@ ssize_t isp::ISP::send(const std::string& command,
         {
             unsigned readTime = 0U;
 
+            if (retry < retryCount - 1)
+                mMetrics.count(isp::Metrics::COUNTER_RETRIES);
+
             // Clear out the response
             response.clear();
 
@@ -1025,7 +1057,7 @@ ssize_t isp::ISP::send(const std::string& command,
             // Send the command
             mSerial.write(command.c_str(), size);
 
-            bytesRead = mSerial.read(response, timeoutInMS, readTime, isVerbose);
+            bytesRead = mSerial.read(response, isComplete, timeoutInMS, readTime, isVerbose);
             if (bytesRead > 0)
             {
                 if (isVerbose)
@@ -1034,6 +1066,10 @@ ssize_t isp::ISP::send(const std::string& command,
                                            response.length());
                 return response.length();
             }
+
+            // A cancel ends every wait, so retrying would only spin
+            if ((bytesRead < 0) && isp::Serial::isCancelled())
+                return bytesRead;
         }
         bytesRead = -2;
     }
@@ -1047,6 +1083,7 @@ ssize_t isp::ISP::send(const std::string& command,
 ssize_t isp::ISP::send(const std::string& command,
                        std::string& response,
                        std::string& testResponse,
+                       const isp::Serial::tFrameCheck& isComplete,
                        unsigned timeoutInMS,
                        bool isVerbose,
                        int retryCount)
@@ -1061,6 +1098,9 @@ ssize_t isp::ISP::send(const std::string& command,
         {
             unsigned readTime = 0U;
 
+            if (retry < retryCount - 1)
+                mMetrics.count(isp::Metrics::COUNTER_RETRIES);
+
             // Clear out the response
             response.clear();
 
@@ -1072,7 +1112,7 @@ ssize_t isp::ISP::send(const std::string& command,
             // Send the command
             mSerial.write(command.c_str(), size);
 
-            bytesRead = mSerial.read(response, timeoutInMS, readTime, isVerbose);
+            bytesRead = mSerial.read(response, isComplete, timeoutInMS, readTime, isVerbose);
             if (bytesRead > 0)
             {
                 if (isVerbose)
@@ -1083,55 +1123,9 @@ ssize_t isp::ISP::send(const std::string& command,
                 if (response.find(testResponse) != std::string::npos)
                     return response.length();
             }
-            bytesRead = -2;
-        }
-    }
-    return bytesRead;
-}
-
-
-//
-//  @brief      Send a command to the serial interface and get a response.
-//
-ssize_t isp::ISP::send(const std::string& command,
-                       std::vector<uint8_t>& response,
-                       std::string& testResponse,
-                       unsigned timeoutInMS,
-                       bool isVerbose,
-                       int retryCount)
-{
-    ssize_t bytesRead = -1;
-    size_t size = command.length();
-    int retry = retryCount;
-
-    if (mSerial.isOpen())
-    {
-        while (--retry)
-        {
-            unsigned readTime = 0U;
-
-            // Clear out the response
-            response.clear();
-
-            if (isVerbose)
-                isp::Utility::hexDump(reinterpret_cast<const uint8_t *>(
-                                            command.c_str()),
-                                       size);
-
-            // Send the command
-            mSerial.write(command.c_str(), size);
-
-            bytesRead = mSerial.read(response, timeoutInMS, readTime, isVerbose);
-            if (bytesRead > 0)
+            else if ((bytesRead < 0) && isp::Serial::isCancelled())
             {
-                if (isVerbose)
-                    isp::Utility::hexDump(reinterpret_cast<const uint8_t *>(
-                                                response.data()),
-                                           response.size());
-
-                if (strstr(reinterpret_cast<const char *>(response.data()),
-                             testResponse.c_str()))
-                    return response.size();
+                return bytesRead;
             }
             bytesRead = -2;
         }
@@ -1154,8 +1148,9 @@ ssize_t isp::ISP::send(std::vector<uint8_t>& bytes,
         if (isVerbose)
             isp::Utility::hexDump(bytes.data(), size);
 
-        // Send the command
+        // Send the data and wait for it to reach the target
         mSerial.write(reinterpret_cast<const char *>(bytes.data()), size);
+        mSerial.drain();
 
         bytesRead = size;
     }
@@ -1164,60 +1159,114 @@ ssize_t isp::ISP::send(std::vector<uint8_t>& bytes,
 
 
 //
-//  @brief      Open up a HW signal for access.
+//  @brief      Send a command and parse its reply from the receive buffer.
 //
-int isp::ISP::hwSignalOpen(const char * signal)
+isp::ISP::Error isp::ISP::transact(const char * command,
+                                   size_t length,
+                                   isp::Response& response,
+                                   unsigned timeoutInMS,
+                                   bool isVerbose,
+                                   int retryCount,
+                                   const uint8_t * pPayload,
+                                   size_t payloadSize)
 {
-    int fd = open(signal, O_WRONLY);
+    isp::RingBuffer& rxBuffer = mSerial.getRxBuffer();
+    struct iovec iov[ 2 ] = {
+        { const_cast<char *>(command), length },
+        { const_cast<uint8_t *>(pPayload), payloadSize }
+    };
 
-    if (fd < 0)
-    {
-        LOG(ERROR) << "Open failed for signal '"
-                   << signal
-                   << "' -- " << errno << " " << strerror(errno);
-    }
-    return fd;
-}
+    Error error = ERR_ISP_TIMEOUT;
 
+    if (!mSerial.isOpen())
+        return error;
 
-//
-//  @brief      Close down a HW signal from access.
-//
-void isp::ISP::hwSignalClose(int fd,
-                             const char * signal)
-{
-    if (fd >= 0)
+    for (int attempt = 0; attempt < retryCount; ++attempt)
     {
-        int result = close(fd);
+        ssize_t result = 1;
 
-        if (result < 0)
+        // Whatever is left of an earlier reply must not be taken for this
+        // one.  After a failed attempt, also wait for the line to go quiet
+        // so that a late reply to it is dropped.
+        mSerial.flush();
+        if (attempt)
         {
-            LOG(ERROR) << "Close failed for signal '"
-                       << signal
-                       << "' -- " << errno << " " << strerror(errno);
+            unsigned readTime = 0U;
+
+            mMetrics.count(isp::Metrics::COUNTER_RETRIES);
+            while (mSerial.fill(MINIMAL_TIMEOUT, readTime) > 0)
+                mSerial.flush();
         }
+
+        if (isVerbose)
+            isp::Utility::hexDump(reinterpret_cast<const uint8_t *>(command), length);
+
+        // The command is echoed at the setting in force when it is sent
+        response.start(mIsEcho? command: nullptr, length);
+        if (mSerial.write(iov, pPayload? 2: 1) < 0)
+            break;
+
+        // Parse in place; bytes after the reply stay buffered
+        while (!response.isDone() && (result > 0))
+        {
+            if (rxBuffer.isEmpty())
+            {
+                unsigned readTime = 0U;
+                size_t wanted = 0U;
+                uint8_t * pData = response.getDataSpan(wanted);
+
+                // Raw data of known length goes straight to the caller
+                if (wanted)
+                {
+                    if ((result = mSerial.fill(pData, wanted, timeoutInMS, readTime)) > 0)
+                    {
+                        if (isVerbose)
+                            isp::Utility::hexDump(pData, result);
+                        response.commitData(result);
+                    }
+                }
+                else
+                {
+                    result = mSerial.fill(timeoutInMS, readTime);
+                }
+                continue;
+            }
+
+            isp::RingBuffer::Span span = rxBuffer.getReadSpan();
+            size_t used = response.parse(span.pData, span.size);
+
+            if (isVerbose)
+                isp::Utility::hexDump(span.pData, used);
+            rxBuffer.consume(used);
+        }
+
+        if (response.isDone() && (response.getStatus() != isp::Response::BAD_STATUS))
+            return static_cast<Error>(response.getStatus());
+
+        error = response.isDone()? ERR_ISP_BAD_RESPONSE: ERR_ISP_TIMEOUT;
+
+        // A cancelled or failed read is not worth repeating
+        if (result < 0)
+            break;
     }
+    return error;
 }
 
 
 //
-//  @brief      Set a signal to a given state.
+//  @brief      Build a completion test for a literal reply.
 //
-void isp::ISP::hwSignalSet(int fd,
-                           const char * signal,
-                           bool value)
+isp::Serial::tFrameCheck isp::ISP::contains(const std::string& pattern)
 {
-    if (fd >= 0)
-    {
-        std::string vString = (value? "1\n": "0\n" );
+    size_t scanned = 0U;
 
-        int result = ::write(fd, vString.c_str(), vString.size());
-        if (result < 0)
-        {
-            LOG(ERROR) << "Write failed for signal '"
-                       << signal
-                       << "' -- " << errno << " " << strerror(errno);
+    // Only the bytes since the last call, and enough before them to catch
+    // a match split across two reads, are searched
+    return [pattern, scanned](const uint8_t * pBuffer, size_t size) mutable
+    {
+        size_t from = (scanned >= pattern.length())? (scanned - pattern.length() + 1U): 0U;
 
-        }
-    }
+        scanned = size;
+        return (memmem(pBuffer + from, size - from, pattern.data(), pattern.length()) != NULL);
+    };
 }
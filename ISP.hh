@@ -10,6 +10,8 @@
 // Includes
 #include <stdint.h>
 #include <string.h>
+#include "Metrics.hh"
+#include "Response.hh"
 #include "Serial.hh"
 
 
@@ -26,6 +28,7 @@ class ISP
 {
 public:
     typedef enum {
+        ERR_ISP_BAD_RESPONSE = -2,          // Reply was not a decimal code
         ERR_ISP_TIMEOUT = -1,
         ERR_ISP_NO_ERROR = 0,
         ERR_ISP_INVALID_COMMAND,
@@ -107,6 +110,21 @@ public:
     ///
     Error synchronize(bool isVerbose = false);
 
+    ///
+    /// @brief      Synchronize to a target already in ISP mode.
+    ///
+    /// @details    Answers without a reset if the bootloader is waiting for
+    ///             autobaud or was left synchronized at the current baud
+    ///             rate by an earlier session.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
+    ///
+    Error detect(bool isVerbose = false);
+
 
     ///
     /// @brief      Set the baud rate and number of stop bits
@@ -129,6 +147,99 @@ public:
                       unsigned timeoutInMS = SHORT_TIMEOUT,
                       bool isVerbose = false);
 
+    ///
+    /// @brief      Negotiate the fastest baud rate the link will carry.
+    ///
+    /// @details    Each standard rate up to the limit is offered to the
+    ///             target from the fastest down.  When the target accepts
+    ///             a rate, the host port follows and a CRC probe confirms
+    ///             the link; otherwise both ends return to the old rate
+    ///             and the next rate is tried.
+    ///
+    /// @param[in]  maxBaud
+    ///             The highest baud rate to try.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The timeout value in milliseconds for each reply.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @return     The error code for the operation where zero is success,
+    ///             even if no faster rate was found, and any other value
+    ///             means the link was lost.
+    ///
+    Error negotiateBaudRate(unsigned maxBaud,
+                            unsigned timeoutInMS = SHORT_TIMEOUT,
+                            bool isVerbose = false);
+
+    ///
+    /// @brief      Drop the link to the next slower baud rate.
+    ///
+    /// @details    Used when transfers start failing at the negotiated
+    ///             rate.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The timeout value in milliseconds for each reply.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error, including already running
+    ///             at the slowest rate.
+    ///
+    Error fallbackBaudRate(unsigned timeoutInMS = SHORT_TIMEOUT,
+                           bool isVerbose = false);
+
+    ///
+    /// @brief      Send write data in the same write as its command.
+    ///
+    /// @details    Saves a round trip per 'W' command when echo is off.
+    ///             The target has to buffer the data while it parses the
+    ///             command, so this is off by default.
+    ///
+    /// @param[in]  isPipeline
+    ///             Boolean true to send the data without waiting for the
+    ///             command status.
+    ///
+    void setPipeline(bool isPipeline) { mIsPipeline = isPipeline; }
+
+    ///
+    /// @brief      Get the baud rate the link is running at.
+    ///
+    /// @return     The baud rate of the host port.
+    ///
+    unsigned getBaudRate() { return mSerial.getBaudRate(); }
+
+    ///
+    /// @brief      Get the phase timing for this connection.
+    ///
+    /// @return     Reference to the metrics.
+    ///
+    isp::Metrics& getMetrics() { return mMetrics; }
+
+    ///
+    /// @brief      Determine if an error points at the serial link.
+    ///
+    /// @details    Timeouts, unreadable status codes and commands the
+    ///             target could not parse are what a noisy or overrun
+    ///             link produces; the other codes are genuine answers.
+    ///
+    /// @param[in]  error
+    ///             The error code to check.
+    ///
+    /// @return     Boolean true if the error is a link error.
+    ///
+    static bool isLinkError(Error error)
+    {
+        return (error == ERR_ISP_TIMEOUT)         ||
+               (error == ERR_ISP_BAD_RESPONSE)    ||
+               (error == ERR_ISP_INVALID_COMMAND) ||
+               (error <  ERR_ISP_TIMEOUT)         ||
+               (error >  ERR_ISP_REINVOKE_ISP_CONFIG);
+    }
+
     ///
     /// @brief      Query the chip identifier for the target.
     ///
@@ -325,6 +436,44 @@ public:
                      unsigned timeoutInMS = LONG_TIMEOUT,
                      bool isVerbose = false);
 
+    ///
+    /// @brief      Read memory from the target device into a buffer.
+    ///
+    /// @details    The reply is framed by its length alone, so the data may
+    ///             hold any byte values.  Once the return code is parsed the
+    ///             data is read straight into the buffer.  The size is only
+    ///             limited by the target; a whole flash sector can be read
+    ///             in one command.
+    ///
+    /// @param[in]  address
+    ///             The address at which to start reading from.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes to read, a multiple of four.
+    ///
+    /// @param[out] pBuffer
+    ///             The buffer to read into; at least size bytes.
+    ///
+    /// @param[out] bytesRead
+    ///             The number of bytes placed in the buffer.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The timeout value in milliseconds for each part of the
+    ///             reply.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error
+    ///
+    Error readMemory(uint32_t address,
+                     size_t size,
+                     uint8_t * pBuffer,
+                     size_t& bytesRead,
+                     unsigned timeoutInMS = LONG_TIMEOUT,
+                     bool isVerbose = false);
+
     ///
     /// @brief      Enable / disable command echoing from the target.
     ///
@@ -427,6 +576,9 @@ protected:
     /// @param[out] response
     ///             The string to fill in for the response.
     ///
+    /// @param[in]  isComplete
+    ///             The completion test for the response.
+    ///
     /// @param[in]  timeoutInMS
     ///             The timeout value in milliseconds for the reply.
     ///
@@ -442,6 +594,7 @@ protected:
     ///
     ssize_t send(const std::string& command,
                  std::string& response,
+                 const isp::Serial::tFrameCheck& isComplete,
                  unsigned timeoutInMS,
                  bool isVerbose = false,
                  int retryCount = 3);
@@ -461,40 +614,8 @@ protected:
     /// @param[out] testResponse
     ///             The string to use to test with.
     ///
-    /// @param[in]  timeoutInMS
-    ///             The timeout value in milliseconds for the reply.
-    ///
-    /// @param[in]  isVerbose
-    ///             The flag for the verbosity level.
-    ///
-    /// @param[in]  retryCount
-    ///             The number of attempts to make before aborting.
-    ///
-    /// @retval     > 0:    The number of characters in the response.
-    ///             -1:     Error encountered.
-    ///             -2:     Timeout
-    ///
-    ssize_t send(const std::string& command,
-                 std::string& response,
-                 std::string& testResponse,
-                 unsigned timeoutInMS,
-                 bool isVerbose = false,
-                 int retryCount = 3);
-
-    ///
-    /// @brief      Send a command to the serial interface and get a response.
-    ///
-    /// @details    Send a command to the serial interface, wait to get the
-    ///             appropriate response or a timeout.
-    ///
-    /// @param[in]  command
-    ///             The command string to be sent.
-    ///
-    /// @param[out] response
-    ///             The vector to fill in for the response.
-    ///
-    /// @param[out] testResponse
-    ///             The string to use to test with.
+    /// @param[in]  isComplete
+    ///             The completion test for the response.
     ///
     /// @param[in]  timeoutInMS
     ///             The timeout value in milliseconds for the reply.
@@ -510,8 +631,9 @@ protected:
     ///             -2:     Timeout
     ///
     ssize_t send(const std::string& command,
-                 std::vector<uint8_t>& response,
+                 std::string& response,
                  std::string& testResponse,
+                 const isp::Serial::tFrameCheck& isComplete,
                  unsigned timeoutInMS,
                  bool isVerbose = false,
                  int retryCount = 3);
@@ -536,6 +658,16 @@ protected:
     ssize_t send(std::vector<uint8_t>& bytes,
                  bool isVerbose = false);
 
+    ///
+    /// @brief      Build a completion test for a literal reply.
+    ///
+    /// @param[in]  pattern
+    ///             The string that completes the reply.
+    ///
+    /// @return     The completion test.
+    ///
+    static isp::Serial::tFrameCheck contains(const std::string& pattern);
+
 private:
     ///
     /// @brief      Default constructor.
@@ -568,45 +700,131 @@ private:
     ISP& operator = (const ISP& ref) = delete;
 
     ///
-    /// @brief      Open up a HW signal for access.
+    /// @brief      Send '?' until the bootloader answers.
     ///
-    /// @param[in]  signal
-    ///             The signal name string to use to access the signal
-    ///             through GPIO.
+    /// @details    Each probe waits for the answer for a number of byte
+    ///             times at the current baud rate rather than a fixed time.
     ///
-    /// @return     The signal's file descriptor on success or neg on on error.
+    /// @param[in]  timeoutInMS
+    ///             The time to keep probing; zero sends a single probe.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
     ///
-    int hwSignalOpen(const char * signal);
+    Error probe(unsigned timeoutInMS, bool isVerbose);
 
     ///
-    /// @brief      Close down a HW signal from access.
+    /// @brief      Finish synchronization after the bootloader answered.
     ///
-    /// @param[in]  fd
-    ///             The signal's file descriptor.
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
     ///
-    /// @param[in]  signal
-    ///             The signal name string to use to access the signal
-    ///             through GPIO.
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
     ///
-    void hwSignalClose(int fd,
-                       const char * signal);
+    Error handshake(bool isVerbose);
 
     ///
-    /// @brief      Set a signal to a given state.
+    /// @brief      Confirm the link with an ID query.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
+    ///
+    Error identify(bool isVerbose);
+
+    ///
+    /// @brief      Get the time to wait for the answer to one probe.
+    ///
+    /// @return     The time in milliseconds.
+    ///
+    unsigned getProbeInterval();
+
+    ///
+    /// @brief      Move both ends of the link to a new baud rate.
+    ///
+    /// @details    On failure both ends are asked to return to the old
+    ///             rate.
+    ///
+    /// @param[in]  baud
+    ///             The new baud rate.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The timeout value in milliseconds for each reply.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
+    ///
+    Error changeBaudRate(unsigned baud,
+                         unsigned timeoutInMS,
+                         bool isVerbose);
+
+    ///
+    /// @brief      Confirm the link carries commands at the current rate.
+    ///
+    /// @details    Two CRC queries of the start of flash must both succeed
+    ///             and agree.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The timeout value in milliseconds for each reply.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
+    ///
+    Error probeLink(unsigned timeoutInMS);
+
+    ///
+    /// @brief      Send a command and parse its reply from the receive buffer.
+    ///
+    /// @details    The reply is parsed in place as it arrives, so nothing is
+    ///             copied except raw data, and any bytes after the reply
+    ///             stay buffered for the next command.
+    ///
+    /// @param[in]  command
+    ///             The command line, with its CR-LF.
+    ///
+    /// @param[in]  length
+    ///             The length of the command line.
+    ///
+    /// @param[in,out] response
+    ///             The parser for the reply.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The timeout value in milliseconds for each part of the
+    ///             reply.
+    ///
+    /// @param[in]  isVerbose
+    ///             The flag for the verbosity level.
+    ///
+    /// @param[in]  retryCount
+    ///             The number of attempts to make before aborting.
     ///
-    /// @param[in]  fd
-    ///             The signal's file descriptor.
+    /// @param[in]  pPayload
+    ///             Bytes to send in the same write after the command, or
+    ///             nullptr.
     ///
-    /// @param[in]  signal
-    ///             The signal name string to use to access the signal
-    ///             through GPIO.
+    /// @param[in]  payloadSize
+    ///             The number of payload bytes.
     ///
-    /// @param[in]  value
-    ///             The boolean value to use on the signal.
+    /// @return     The return code of the reply, or ERR_ISP_TIMEOUT if no
+    ///             complete reply arrived.
     ///
-    void hwSignalSet(int fd,
-                     const char * signal,
-                     bool value);
+    Error transact(const char * command,
+                   size_t length,
+                   isp::Response& response,
+                   unsigned timeoutInMS,
+                   bool isVerbose,
+                   int retryCount = 3,
+                   const uint8_t * pPayload = nullptr,
+                   size_t payloadSize = 0U);
 
     // Data members
     isp::Serial&    mSerial;
@@ -614,6 +832,8 @@ private:
     bool            mIsVerbose;
     std::string     mChipId;
     bool            mIsEcho;
+    bool            mIsPipeline;
+    isp::Metrics    mMetrics;
 };  // class
 
 } // namespace
@@ -0,0 +1,415 @@
+///
+/// @file   ImageCache.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+#include "ImageCache.hh"
+#include "Log.hh"
+#include "Part.hh"
+#include "Utility.hh"
+
+
+//  Definitions
+#define CACHE_MAGIC     "ISP15IMG"
+#define CACHE_VERSION   (3U)
+
+//  Round a size up to a whole number of 32-bit words
+#define ALIGN4(size)    (((size) + 3U) & ~static_cast<size_t>(3U))
+
+
+//  Type definitions
+typedef struct
+{
+    char            magic[ 8 ];     ///< CACHE_MAGIC, not terminated
+    uint32_t        version;        ///< CACHE_VERSION
+    uint32_t        headerSize;     ///< Size of this header in bytes
+    uint64_t        key[ 2 ];       ///< Digest of the source file
+    uint64_t        sourceSize;     ///< Size of the source file in bytes
+    uint32_t        entrySize;      ///< Size of the whole entry in bytes
+    uint32_t        extentCount;    ///< Number of tExtent records
+    uint32_t        sectorCount;    ///< One past the end sector
+    uint32_t        sectorSize;     ///< Flash sector size in bytes
+    uint32_t        vectorChecksum; ///< Patched word 7 of the vector table
+    uint8_t         fill;           ///< Value of the gaps
+    uint8_t         reserved[ 3 ];
+    uint64_t        bodyDigest[ 2 ];///< Digest of the rest of the entry
+} tHeader;
+
+typedef struct
+{
+    uint32_t        address;        ///< Address of the first byte
+    uint32_t        size;           ///< Number of bytes
+    uint32_t        offset;         ///< Offset of the bytes in the entry
+} tExtent;
+
+
+//
+//  @brief      Explicit constructor for the ImageCache class.
+//
+isp::ImageCache::ImageCache(const std::string& directory)
+        : mDirectory(directory),
+          mKey(),
+          mSourceSize(0U)
+{}
+
+
+//
+//  @brief      Load the image cached for a source file.
+//
+bool isp::ImageCache::load(const std::string& source, FirmwareImage& image)
+{
+    bool        result = false;
+    int         fileDes = -1;
+    void *      pMap = MAP_FAILED;
+    struct stat info;
+
+    image.clear();
+
+    do
+    {
+        if (!makeKey(source))
+            break;
+
+        if ((fileDes = open(mPath.c_str(), O_RDONLY | O_CLOEXEC)) < 0)
+        {
+            LOG(INFO) << "Image cache miss for '" << source << "'";
+            break;
+        }
+
+        if (fstat(fileDes, &info) < 0 || info.st_size < static_cast<off_t>(sizeof(tHeader)))
+            break;
+
+        pMap = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fileDes, 0);
+        if (pMap == MAP_FAILED)
+            break;
+
+        result = restore(static_cast<const uint8_t *>(pMap), info.st_size, image);
+        if (!result)
+        {
+            LOG(WARNING) << "Ignoring bad cache entry '" << mPath << "'";
+            image.clear();
+            break;
+        }
+        LOG(INFO) << "Image cache hit for '" << source << "': " << mPath;
+
+    } while (false);
+
+    if (pMap != MAP_FAILED)
+        munmap(pMap, info.st_size);
+    if (fileDes >= 0)
+        close(fileDes);
+
+    return result;
+}
+
+
+//
+//  @brief      Store an image under the key of the last load.
+//
+bool isp::ImageCache::store(const FirmwareImage& image)
+{
+    const std::vector<FirmwareImage::Extent>& extents = image.getExtents();
+    std::vector<uint8_t> entry;
+    tHeader header;
+
+    if (mPath.empty() || extents.empty())
+        return false;
+
+    uint32_t count = image.getEndSector() + 1U;
+    size_t   extentOffset = sizeof(tHeader);
+    size_t   crcOffset    = extentOffset + extents.size() * sizeof(tExtent);
+    size_t   flagOffset   = crcOffset + count * sizeof(uint32_t);
+    size_t   dataOffset   = ALIGN4(flagOffset + count);
+    size_t   size         = dataOffset;
+
+    for (const FirmwareImage::Extent& extent : extents)
+        size += ALIGN4(extent.data.size());
+
+    if (size > UINT32_MAX)
+        return false;
+
+    // The vector table sits at the start of the image
+    uint32_t checksum = 0U;
+    image.read(image.getStartAddress() + 7 * sizeof(uint32_t),
+               reinterpret_cast<uint8_t *>(&checksum), sizeof(checksum));
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version        = CACHE_VERSION;
+    header.headerSize     = sizeof(tHeader);
+    header.key[ 0 ]       = mKey[ 0 ];
+    header.key[ 1 ]       = mKey[ 1 ];
+    header.sourceSize     = mSourceSize;
+    header.entrySize      = size;
+    header.extentCount    = extents.size();
+    header.sectorCount    = count;
+    header.sectorSize     = isp::Part::SECTOR_SIZE;
+    header.vectorChecksum = checksum;
+    header.fill           = image.getFill();
+
+    entry.resize(size, 0U);
+
+    size_t offset = dataOffset;
+    for (size_t ii = 0; ii < extents.size(); ++ii)
+    {
+        tExtent record = { extents[ ii ].address,
+                           static_cast<uint32_t>(extents[ ii ].data.size()),
+                           static_cast<uint32_t>(offset) };
+
+        memcpy(&entry[ extentOffset + ii * sizeof(tExtent) ], &record, sizeof(record));
+        memcpy(&entry[ offset ], extents[ ii ].data.data(), record.size);
+        offset += ALIGN4(record.size);
+    }
+
+    for (uint32_t sector = 0U; sector < count; ++sector)
+    {
+        uint32_t crc = image.getCRC(sector);
+
+        memcpy(&entry[ crcOffset + sector * sizeof(uint32_t) ], &crc, sizeof(crc));
+        entry[ flagOffset + sector ] = image.getFlags(sector);
+    }
+
+    hash(&entry[ sizeof(tHeader) ], size - sizeof(tHeader), header.key[ 0 ], header.bodyDigest);
+    memcpy(&entry[ 0 ], &header, sizeof(header));
+
+    if (mkdir(mDirectory.c_str(), 0755) < 0 && errno != EEXIST)
+    {
+        LOG(WARNING) << "Cannot make cache directory '" << mDirectory << "' -- "
+                     << errno << " " << strerror(errno);
+        return false;
+    }
+
+    // Write under a temporary name so no reader sees a partial entry
+    std::string tempName = mPath + "." + std::to_string(getpid());
+    int error   = 0;
+    int fileDes = open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fileDes < 0)
+        error = errno;
+    else
+    {
+        ssize_t written = ::write(fileDes, entry.data(), entry.size());
+
+        if (written < 0)
+            error = errno;
+        else if (written != static_cast<ssize_t>(entry.size()))
+            error = ENOSPC;
+
+        if (close(fileDes) != 0 && error == 0)
+            error = errno;
+    }
+
+    if (error == 0 && rename(tempName.c_str(), mPath.c_str()) != 0)
+        error = errno;
+
+    if (error == 0)
+    {
+        LOG(INFO) << "Image cached as " << mPath;
+        return true;
+    }
+
+    LOG(WARNING) << "Cannot write cache entry '" << mPath << "' -- "
+                 << error << " " << strerror(error);
+    unlink(tempName.c_str());
+    return false;
+}
+
+
+//
+//  @brief      Rotate a 64-bit word left.
+//
+static inline uint64_t rotl(uint64_t value, unsigned count)
+{
+    return (value << count) | (value >> (64U - count));
+}
+
+
+//
+//  @brief      Mix every bit of a 64-bit word into every other.
+//
+static inline uint64_t fmix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDULL;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+
+//
+//  @brief      Digest a block of bytes.
+//
+void isp::ImageCache::hash(const uint8_t * pBlock,
+                           size_t size,
+                           uint64_t seed,
+                           uint64_t (&digest)[ 2 ])
+{
+    const uint64_t c1 = 0x87C37B91114253D5ULL;
+    const uint64_t c2 = 0x4CF5AD432745937FULL;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+    uint64_t k1;
+    uint64_t k2;
+    size_t   ii = 0;
+
+    for (; ii + 2 * sizeof(uint64_t) <= size; ii += 2 * sizeof(uint64_t))
+    {
+        memcpy(&k1, pBlock + ii, sizeof(k1));
+        memcpy(&k2, pBlock + ii + sizeof(k1), sizeof(k2));
+
+        k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+
+        k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+    }
+
+    // The last 1 to 15 bytes, little-endian
+    size_t tail = size - ii;
+
+    k1 = 0U;
+    k2 = 0U;
+    for (size_t jj = 0; jj < tail; ++jj)
+    {
+        if (jj < sizeof(k1))
+            k1 |= static_cast<uint64_t>(pBlock[ ii + jj ]) << (8 * jj);
+        else
+            k2 |= static_cast<uint64_t>(pBlock[ ii + jj ]) << (8 * (jj - sizeof(k1)));
+    }
+
+    if (tail > sizeof(k1))
+    {
+        k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+    if (tail > 0U)
+    {
+        k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= size;
+    h2 ^= size;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix(h1);
+    h2 = fmix(h2);
+    h1 += h2;
+    h2 += h1;
+
+    digest[ 0 ] = h1;
+    digest[ 1 ] = h2;
+}
+
+
+//
+//  @brief      Hash the source file to make the entry path.
+//
+bool isp::ImageCache::makeKey(const std::string& source)
+{
+    bool        result = false;
+    int         fileDes = -1;
+    void *      pMap = MAP_FAILED;
+    struct stat info;
+    std::string extension = isp::Utility::ExtractFileExtension(source);
+
+    mPath.clear();
+
+    do
+    {
+        if ((fileDes = open(source.c_str(), O_RDONLY | O_CLOEXEC)) < 0 ||
+            fstat(fileDes, &info) < 0 || info.st_size == 0)
+            break;
+
+        pMap = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fileDes, 0);
+        if (pMap == MAP_FAILED)
+            break;
+        madvise(pMap, info.st_size, MADV_SEQUENTIAL);
+
+        // The extension picks the loader, so it seeds the key
+        uint64_t seed[ 2 ];
+
+        hash(reinterpret_cast<const uint8_t *>(extension.data()), extension.size(), 0U, seed);
+        hash(static_cast<const uint8_t *>(pMap), info.st_size, seed[ 0 ], mKey);
+        mSourceSize = info.st_size;
+
+        char name[ 40 ];
+        snprintf(name, sizeof(name), "%016llx%016llx.img",
+                 static_cast<unsigned long long>(mKey[ 1 ]),
+                 static_cast<unsigned long long>(mKey[ 0 ]));
+        mPath = mDirectory + "/" + name;
+        result = true;
+
+    } while (false);
+
+    if (pMap != MAP_FAILED)
+        munmap(pMap, info.st_size);
+    if (fileDes >= 0)
+        close(fileDes);
+
+    return result;
+}
+
+
+//
+//  @brief      Fill in the image from a mapped entry.
+//
+bool isp::ImageCache::restore(const uint8_t * pEntry, size_t size, FirmwareImage& image)
+{
+    const tHeader * pHeader = reinterpret_cast<const tHeader *>(pEntry);
+
+    if (memcmp(pHeader->magic, CACHE_MAGIC, sizeof(pHeader->magic)) != 0 ||
+        pHeader->version != CACHE_VERSION ||
+        pHeader->headerSize != sizeof(tHeader) ||
+        pHeader->entrySize != size ||
+        pHeader->key[ 0 ] != mKey[ 0 ] ||
+        pHeader->key[ 1 ] != mKey[ 1 ] ||
+        pHeader->sourceSize != mSourceSize ||
+        pHeader->sectorSize != isp::Part::SECTOR_SIZE ||
+        pHeader->fill != image.getFill() ||
+        pHeader->extentCount == 0U)
+        return false;
+
+    // Nothing past the header is trusted until its digest matches
+    uint64_t digest[ 2 ];
+    hash(pEntry + sizeof(tHeader), size - sizeof(tHeader), pHeader->key[ 0 ], digest);
+    if (digest[ 0 ] != pHeader->bodyDigest[ 0 ] || digest[ 1 ] != pHeader->bodyDigest[ 1 ])
+        return false;
+
+    uint64_t crcOffset  = sizeof(tHeader) + static_cast<uint64_t>(pHeader->extentCount) * sizeof(tExtent);
+    uint64_t flagOffset = crcOffset + static_cast<uint64_t>(pHeader->sectorCount) * sizeof(uint32_t);
+
+    if (flagOffset + pHeader->sectorCount > size)
+        return false;
+
+    const tExtent * pExtents = reinterpret_cast<const tExtent *>(pEntry + sizeof(tHeader));
+
+    for (uint32_t ii = 0; ii < pHeader->extentCount; ++ii)
+    {
+        const tExtent& extent = pExtents[ ii ];
+
+        if ((extent.offset > size) || (extent.size > size - extent.offset) ||
+            !image.write(extent.address, pEntry + extent.offset, extent.size))
+            return false;
+    }
+
+    if (!image.setIndex(pEntry + flagOffset,
+                        reinterpret_cast<const uint32_t *>(pEntry + crcOffset),
+                        pHeader->sectorCount))
+        return false;
+
+    LOG(INFO) << "Vector checksum 0x" << std::hex << pHeader->vectorChecksum
+              << " from the cache";
+    return true;
+}
@@ -0,0 +1,142 @@
+///
+/// @file   ImageCache.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef IMAGECACHE_HH_
+#define IMAGECACHE_HH_
+
+//  Includes
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "FirmwareImage.hh"
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Directory of firmware images ready to program.
+///
+/// @details    Each entry is named by a 128-bit MurmurHash3 digest of the
+///             source file, seeded by its extension, and is one flat blob:
+///             a header holding the digest, the extent list, the flags and
+///             CRC-32 of each sector and the extent data, every part 4-byte
+///             aligned.  The header also holds a digest of everything after
+///             it, which is checked before an entry is used.  An entry is
+///             mapped and copied into the image with no parsing, so the
+///             checksum patch and sector index are worked out once per
+///             source file.
+///             Entries are written under a temporary name and renamed, so
+///             a reader never sees one half written.
+///
+class ImageCache
+{
+public:
+    ///
+    /// @brief      Explicit constructor for the ImageCache class.
+    ///
+    /// @param[in]  directory
+    ///             The cache directory; the first store makes it if it
+    ///             does not exist.
+    ///
+    explicit ImageCache(const std::string& directory);
+
+    ///
+    /// @brief      Default destructor for the ImageCache class.
+    ///
+    ~ImageCache() {}
+
+    ///
+    /// @brief      Load the image cached for a source file.
+    ///
+    /// @details    The source file is hashed, and the key kept for a store
+    ///             that follows a miss.
+    ///
+    /// @param[in]  source
+    ///             The path of the source file.
+    ///
+    /// @param[out] image
+    ///             The image to fill in and index; cleared first.
+    ///
+    /// @return     Boolean true on a hit; false on a miss or a bad entry,
+    ///             which leaves the image empty.
+    ///
+    bool load(const std::string& source, FirmwareImage& image);
+
+    ///
+    /// @brief      Store an image under the key of the last load.
+    ///
+    /// @param[in]  image
+    ///             The indexed image parsed from the source file.
+    ///
+    /// @return     Boolean true if the entry was written.
+    ///
+    bool store(const FirmwareImage& image);
+
+    ///
+    /// @brief      Digest a block of bytes.
+    ///
+    /// @details    MurmurHash3 x64 128-bit; every input bit reaches every
+    ///             output bit, so files that differ in a few bits do not
+    ///             share a key.
+    ///
+    /// @param[in]  pBlock
+    ///             The bytes.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    /// @param[in]  seed
+    ///             The seed.
+    ///
+    /// @param[out] digest
+    ///             The 128-bit digest, low word first.
+    ///
+    static void hash(const uint8_t * pBlock,
+                     size_t size,
+                     uint64_t seed,
+                     uint64_t (&digest)[ 2 ]);
+
+private:
+    ImageCache() = delete;
+    ImageCache(const ImageCache& ref) = delete;
+    ImageCache& operator = (const ImageCache& ref) = delete;
+
+    ///
+    /// @brief      Hash the source file to make the entry path.
+    ///
+    /// @param[in]  source
+    ///             The path of the source file.
+    ///
+    /// @return     Boolean false if the file cannot be read.
+    ///
+    bool makeKey(const std::string& source);
+
+    ///
+    /// @brief      Fill in the image from a mapped entry.
+    ///
+    /// @param[in]  pEntry
+    ///             The entry.
+    ///
+    /// @param[in]  size
+    ///             The size of the entry in bytes.
+    ///
+    /// @param[out] image
+    ///             The image to fill in and index.
+    ///
+    /// @return     Boolean false if the entry is not valid for the key.
+    ///
+    bool restore(const uint8_t * pEntry, size_t size, FirmwareImage& image);
+
+    // Data members
+    std::string     mDirectory;
+    std::string     mPath;
+    uint64_t        mKey[ 2 ];
+    uint64_t        mSourceSize;
+};  // class
+
+} // namespace
+#endif
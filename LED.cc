@@ -12,16 +12,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include "Gpio.hh"
 #include "LED.hh"
 #include "Log.hh"
 #include "Utility.hh"
 
 #include "Serial.hh"
 
-//  Definitions
-#define LED_SIGNAL "/sys/class/gpio/gpio25/value"
-
-
 //  External References
 extern  bool    gNoGPIO;
 
@@ -30,20 +27,13 @@ extern  bool    gNoGPIO;
 /// @brief      Default constructor for the LED class.
 ///
 isp::LED::LED()
-        : mFileDes(-1),
-          mCycle(8U),
+        : mCycle(8U),
           mCounter(0U),
           mState(false)
 {
     if (gNoGPIO != true)
     {
-        mFileDes = hwSignalOpen(LED_SIGNAL);
-        if (mFileDes < 0)
-        {
-            LOG(ERROR) << "Cannot open LED signal";
-            return;
-        }
-        hwSignalSet(mFileDes, LED_SIGNAL, false);
+        isp::Gpio::getInstance().setLED(false);
     }
 }
 
@@ -55,8 +45,7 @@ isp::LED::~LED()
 {
     if (gNoGPIO != true)
     {
-        hwSignalSet(mFileDes, LED_SIGNAL, true);
-        hwSignalClose(mFileDes, LED_SIGNAL);
+        isp::Gpio::getInstance().setLED(true);
     }
 }
 
@@ -68,7 +57,7 @@ void isp::LED::Set(bool value)
 {
     if (gNoGPIO != true)
     {
-        hwSignalSet(mFileDes, LED_SIGNAL, value);
+        isp::Gpio::getInstance().setLED(value);
         mState = value;
     }
 }
@@ -87,71 +76,6 @@ bool isp::LED::Get()
 }
 
 
-//
-//  @brief      Open up a HW signal for access.
-//
-int isp::LED::hwSignalOpen(const char * signal)
-{
-    int fd = -1;
-
-    if (gNoGPIO != true)
-    {
-        fd = open(signal, O_RDWR);
-
-        if (fd < 0)
-        {
-            LOG(ERROR) << "Open failed for signal '"
-                       << signal
-                       << "' -- " << errno << " " << strerror(errno);
-        }
-    }
-    return fd;
-}
-
-
-//
-//  @brief      Close down a HW signal from access.
-//
-void isp::LED::hwSignalClose(int fd,
-                             const char * signal)
-{
-    if (fd >= 0)
-    {
-        int result = close(fd);
-
-        if (result < 0)
-        {
-            LOG(ERROR) << "Close failed for signal '"
-                       << signal
-                       << "' -- " << errno << " " << strerror(errno);
-        }
-    }
-}
-
-
-//
-//  @brief      Set a signal to a given state.
-//
-void isp::LED::hwSignalSet(int fd,
-                           const char * signal,
-                           bool value)
-{
-    if (fd >= 0)
-    {
-        std::string vString = (value? "1\n": "0\n" );
-
-        int result = ::write(fd, vString.c_str(), vString.size());
-        if (result < 0)
-        {
-            LOG(ERROR) << "Write failed for signal '"
-                       << signal
-                       << "' -- " << errno << " " << strerror(errno);
-
-        }
-    }
-}
-
-
 //
 //  @brief      Cycle the LED.
 //
@@ -81,49 +81,7 @@ private:
     ///
     LED& operator = (const LED& ref) = delete;
 
-    ///
-    /// @brief      Open up a HW signal for access.
-    ///
-    /// @param[in]  signal
-    ///             The signal name string to use to access the signal
-    ///             through GPIO.
-    ///
-    /// @return     The signal's file descriptor on success or neg on on error.
-    ///
-    int hwSignalOpen(const char * signal);
-
-    ///
-    /// @brief      Close down a HW signal from access.
-    ///
-    /// @param[in]  fd
-    ///             The signal's file descriptor.
-    ///
-    /// @param[in]  signal
-    ///             The signal name string to use to access the signal
-    ///             through GPIO.
-    ///
-    void hwSignalClose(int fd,
-                       const char * signal);
-
-    ///
-    /// @brief      Set a signal to a given state.
-    ///
-    /// @param[in]  fd
-    ///             The signal's file descriptor.
-    ///
-    /// @param[in]  signal
-    ///             The signal name string to use to access the signal
-    ///             through GPIO.
-    ///
-    /// @param[in]  value
-    ///             The boolean value to use on the signal.
-    ///
-    void hwSignalSet(int fd,
-                     const char * signal,
-                     bool value);
-
     // Data members
-    int             mFileDes;
     int             mCycle;
     int             mCounter;
     bool            mState;
@@ -73,7 +73,7 @@ const std::string isp::Log::NowTime()
     struct tm  tm;
     char       buf[80];
 
-    tm = *localtime(&now);
+    localtime_r(&now, &tm);
     strftime(buf, sizeof(buf), "%Y-%m-%d %X", &tm );
     return buf;
 }
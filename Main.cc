@@ -12,16 +12,22 @@
 #include <iostream>
 #include <thread>
 #include <future>
+#include <memory>
+#include <vector>
 #include "Alarm.hh"
 #include "Binary.hh"
 #include "Client.hh"
 #include "CmdLine.hh"
 #include "Elf32.hh"
+#include "FirmwareImage.hh"
+#include "Gpio.hh"
 #include "iHex.hh"
+#include "ImageCache.hh"
 #include "ISP.hh"
 #include "LED.hh"
 #include "Log.hh"
 #include "Serial.hh"
+#include "Session.hh"
 #include "Signal.hh"
 #include "Types.hh"
 #include "Utility.hh"
@@ -37,20 +43,26 @@
 
 //  Global variables
 int         gOption             = NO_OPTION;
-bool        gIsVerbose          = false;
-bool        gIsActiveLowReset   = true;
-bool        gQuit               = false;
-bool        gNoGPIO             = false;
-uint32_t    gStartAddress       = 0U;
-uint32_t    gEndAddress         = 0U;
-uint32_t    gStartSector        = 0U;
-uint32_t    gEndSector          = 0U;
-unsigned    gSyncRetries        = 2;
-uint8_t     gMemory[ 512 * 1024 ];
+
+
+//  External References
+extern  bool        gIsVerbose;
+extern  bool        gIsActiveLowReset;
+extern  bool        gQuit;
+extern  bool        gNoGPIO;
+extern  unsigned    gSyncRetries;
+extern  uint32_t    gStageSize;
+extern  bool        gIsDelta;
+extern  bool        gIsLowLatency;
+extern  bool        gIsRtsCts;
+extern  bool        gIsPipeline;
+extern  unsigned    gMaxBaud;
+extern  isp::FirmwareImage  gImage;
 
 //  Static variables
 static  std::string gInputFilename;
 static  std::string gSerialDevice;
+static  std::string gCacheDirectory;
 static  isp::LED *  gLEDPtr;
 
 ///
@@ -74,64 +86,55 @@ static int fileWorker(
     do
     {
         std::string fileExtension = isp::Utility::ExtractFileExtension(filenameStr);
+        isp::ImageCache cache(gCacheDirectory);
+        bool isCached = gCacheDirectory.size() && cache.load(filenameStr, gImage);
 
-        if (fileExtension == ".hex")
+        if (isCached)
         {
-            isp::iHex    intelHexFile(filenameStr.c_str(), gMemory, sizeof(gMemory));
+            // Parsed, patched and indexed when it was stored
+            result = 0;
+        }
+        else if (fileExtension == ".hex")
+        {
+            isp::iHex    intelHexFile(filenameStr.c_str(), gImage);
 
             if (intelHexFile.parse())
-            {
-                gStartAddress =  intelHexFile.getStartAddress();
-                gEndAddress   =  intelHexFile.getEndAddress();
-                gStartSector  = (intelHexFile.getStartAddress() / FLASH_SECTOR_SIZE);
-                gEndSector    = (intelHexFile.getEndAddress()   / FLASH_SECTOR_SIZE);
-                LOG(INFO) << "Sectors: start="
-                          << std::dec << gStartSector
-                          << " End:="
-                          << std::dec << gEndSector
-                          << " count="
-                          << std::dec << (gEndSector - gStartSector + 1);
                 result = 0;
-            }
         }
         else if (fileExtension == ".axf" || fileExtension == ".elf")
         {
-            isp::Elf32  elf(filenameStr, gMemory, sizeof(gMemory));
+            isp::Elf32  elf(filenameStr, gImage);
 
             if (elf.read() && elf.parse(gIsVerbose))
-            {
-                gStartAddress =  elf.getStartAddress();
-                gEndAddress   =  elf.getEndAddress();
-                gStartSector  = (elf.getStartAddress() / FLASH_SECTOR_SIZE);
-                gEndSector    = (elf.getEndAddress()   / FLASH_SECTOR_SIZE);
-                LOG(INFO) << "Sectors: start="
-                          << std::dec << gStartSector
-                          << " End:="
-                          << std::dec << gEndSector
-                          << " count="
-                          << std::dec << (gEndSector - gStartSector + 1);
                 result = 0;
-            }
         }
         else if (fileExtension == ".bin")
         {
-            isp::Binary binary(filenameStr, gMemory, sizeof(gMemory));
+            isp::Binary binary(filenameStr, gImage);
 
             if (binary.read() && binary.parse())
-            {
-                gStartAddress =  binary.getStartAddress();
-                gEndAddress   =  binary.getEndAddress();
-                gStartSector  = (binary.getStartAddress() / FLASH_SECTOR_SIZE);
-                gEndSector    = (binary.getEndAddress()   / FLASH_SECTOR_SIZE);
-                LOG(INFO) << "Sectors: start="
-                          << std::dec << gStartSector
-                          << " End:="
-                          << std::dec << gEndSector
-                          << " count="
-                          << std::dec << (gEndSector - gStartSector + 1);
                 result = 0;
-            }
         }
+
+        if (result)
+            break;
+
+        // Flag the sectors once, before any board reads the image
+        if (!isCached)
+        {
+            gImage.index();
+            if (gCacheDirectory.size())
+                cache.store(gImage);
+        }
+
+        LOG(INFO) << "Sectors: start="
+                  << std::dec << gImage.getStartSector()
+                  << " End:="
+                  << std::dec << gImage.getEndSector()
+                  << " populated="
+                  << std::dec << gImage.getPopulatedCount()
+                  << " bytes="
+                  << std::dec << gImage.getSize();
     } while (false);
 
     LOG(INFO) << "Leaving fileWorker: result is " << result;
@@ -140,91 +143,149 @@ static int fileWorker(
 
 
 ///
-/// @brief      Erase client worker static method.
+/// @brief      Session worker static method.
 ///
-/// @details    Create the client-side instance to implement ISP client
-///             functionality.  This method will initiate a conversation with
-///             the remote ISP.
+/// @details    Create the client-side session to implement ISP client
+///             functionality.  The target is reset and synchronized once
+///             and every requested step runs on the same connection.
 ///
 /// @param[in]  device
 ///             The device for the serial port.
 ///
+/// @param[in]  steps
+///             The bit mask of isp::Session::Step values to run.
+///
 /// @retval     0           Success.
 /// @retval     <other>     Error.
 ///
-static int eraseWorker(const char * device)
+static int sessionWorker(const char * device, unsigned steps)
 {
     int result = -1;
 
     do
     {
-        isp::ISP::Error error = isp::eraseClient(device, gSyncRetries);
+        isp::Session    session(device, gIsActiveLowReset, gIsVerbose, gMaxBaud);
+        isp::ISP::Error error = session.open(gSyncRetries);
+
+        if (error == isp::ISP::ERR_ISP_NO_ERROR)
+            error = session.run(steps);
+        else
+            session.run(isp::Session::STEP_RUN);
+
+        LOG(INFO) << "Phase times (ms): " << session.getISP().getMetrics().toJSON();
+        LOG(INFO) << "Counters: " << session.getISP().getMetrics().countersToJSON();
         result = static_cast<int>(error);
 
     } while (false);
 
-    LOG(INFO) << "Leaving eraseWorker: result is " << result;
+    LOG(INFO) << "Leaving sessionWorker: result is " << result;
     return result;
 }
 
 
-
-
 ///
-/// @brief      Examine memory client worker static method.
+/// @brief      Gang board worker static method.
 ///
-/// @details    Create the client-side instance to implement ISP client
-///             functionality.  This method will initiate a conversation with
-///             the remote ISP.
+/// @details    Synchronize one board of the gang and run the requested
+///             steps on it.  The fixture has already been reset, and the
+///             image buffer is only read, so every board runs on its own
+///             thread without locking.
 ///
-/// @param[in]  device
-///             The device for the serial port.
+/// @param[in]  session
+///             Pointer to the session for the board.
 ///
-/// @retval     0           Success.
-/// @retval     <other>     Error.
+/// @param[in]  steps
+///             The bit mask of isp::Session::Step values to run.
+///
+/// @return     The error code for the board.
 ///
-static int examineWorker(const char * device)
+static isp::ISP::Error boardWorker(isp::Session * session, unsigned steps)
 {
-    int result = -1;
+    isp::ISP::Error error = session->open(gSyncRetries, false);
 
-    do
-    {
-        isp::ISP::Error error = isp::examineClient(device, gSyncRetries);
-        result = static_cast<int>(error);
-
-    } while (false);
+    if (error == isp::ISP::ERR_ISP_NO_ERROR)
+        error = session->run(steps & ~isp::Session::STEP_RUN);
 
-    LOG(INFO) << "Leaving examineWorker: result is " << result;
-    return result;
+    LOG(INFO) << "Leaving boardWorker(" << session->getDevice()
+              << "): result is " << error;
+    return error;
 }
 
 
 ///
-/// @brief      Client worker static method.
+/// @brief      Gang worker static method.
 ///
-/// @details    Create the client-side instance to implement ISP client
-///             functionality.  This method will initiate a conversation with
-///             the remote ISP.
+/// @details    Program several boards in parallel, one session per serial
+///             port.  The RESET and ISP lines are common to the fixture, so
+///             the boards are reset into ISP mode once, each port runs on
+///             its own thread, and the boards are released into the
+///             application together when all of them are done.
 ///
-/// @param[in]  device
-///             The device for the serial port.
+/// @param[in]  devices
+///             The list of serial port devices.
 ///
-/// @retval     0           Success.
-/// @retval     <other>     Error.
+/// @param[in]  steps
+///             The bit mask of isp::Session::Step values to run.
+///
+/// @retval     0           Every board succeeded.
+/// @retval     <other>     The number of boards that failed.
 ///
-static int clientWorker(const char * device)
+static int gangWorker(const std::vector<std::string>& devices, unsigned steps)
 {
-    int result = -1;
+    // The futures are destroyed first, so on a throw every board is waited
+    // for before the sessions and their ports are released
+    std::vector<std::unique_ptr<isp::Session> > sessions;
+    std::vector<std::future<isp::ISP::Error> >  results;
+    int                                         failures = 0;
 
-    do
+    if (devices.empty())
     {
-        isp::ISP::Error error = isp::programClient(device, gSyncRetries);
-        result = static_cast<int>(error);
+        LOG(ERROR) << "No devices for the gang";
+        return 1;
+    }
 
-    } while (false);
+    for (size_t ii = 0; ii < devices.size(); ++ii)
+        sessions.push_back(std::unique_ptr<isp::Session>(
+                                new isp::Session(devices[ ii ].c_str(),
+                                                 gIsActiveLowReset,
+                                                 gIsVerbose,
+                                                 gMaxBaud)));
 
-    LOG(INFO) << "Leaving clientWorker: result is " << result;
-    return result;
+    // Reset the whole fixture into ISP mode
+    sessions.front()->getISP().programMode();
+
+    for (size_t ii = 0; ii < sessions.size(); ++ii)
+        results.push_back(std::async(std::launch::async,
+                                     boardWorker,
+                                     sessions[ ii ].get(),
+                                     steps));
+
+    std::cout << "Gang summary:" << std::endl;
+    for (size_t ii = 0; ii < results.size(); ++ii)
+    {
+        isp::ISP::Error error = results[ ii ].get();
+
+        std::cout << "  " << std::setfill(' ') << std::left << std::setw(24)
+                  << devices[ ii ] << std::right << std::dec;
+        if (error == isp::ISP::ERR_ISP_NO_ERROR)
+        {
+            std::cout << "PASS" << std::endl;
+        }
+        else
+        {
+            std::cout << "FAIL (error " << error << ")" << std::endl;
+            ++failures;
+        }
+    }
+    std::cout << "  " << (sessions.size() - failures) << " of "
+              << sessions.size() << " boards passed" << std::endl;
+
+    // Release the whole fixture into the application
+    if (steps & isp::Session::STEP_RUN)
+        sessions.front()->getISP().applicationMode();
+
+    LOG(INFO) << "Leaving gangWorker: failures is " << failures;
+    return failures;
 }
 
 
@@ -282,6 +343,9 @@ void termHandler(int event)
             {
                 gQuit = true;
             }
+
+            // Wake every serial wait now rather than at its timeout
+            isp::Serial::cancel();
             break;
 
         default:
@@ -399,12 +463,123 @@ static void doCommandLine(
             index = -1;
         }
 
+        if (cmdLine.find("--legacy", index) ||
+            cmdLine.find("-l", index))
+        {
+            gStageSize = RAM_SECTOR_SIZE;
+            index = -1;
+        }
+
+        if (cmdLine.find("--lowlatency", index) ||
+            cmdLine.find("-L", index))
+        {
+            gIsLowLatency = true;
+            index = -1;
+        }
+
+        if (cmdLine.find("--rtscts", index) ||
+            cmdLine.find("-R", index))
+        {
+            gIsRtsCts = true;
+            index = -1;
+        }
+
+        if (cmdLine.find("--pipeline", index) ||
+            cmdLine.find("-w", index))
+        {
+            gIsPipeline = true;
+            index = -1;
+        }
+
+        if (cmdLine.find("--full", index) ||
+            cmdLine.find("-F", index))
+        {
+            gIsDelta = false;
+            index = -1;
+        }
+
+        if (cmdLine.find("--baud", index) ||
+            cmdLine.find("-b", index))
+        {
+            if (!cmdLine.get(index + 1, argument) ||
+                !isp::Serial::isBaudRate(isp::Utility::stringToUnsigned(argument)))
+            {
+                std::cerr << "No valid baud rate argument found!"
+                          << std::endl;
+
+                error = isp::ISP_INVALID_ARGUMENT;
+                break;
+            }
+            else
+            {
+                gMaxBaud = isp::Utility::stringToUnsigned(argument);
+                index = -1;
+            }
+        }
+
+        if (cmdLine.find("--gpio", index) ||
+            cmdLine.find("-G", index))
+        {
+            if (!cmdLine.get(index + 1, argument) ||
+                !isp::Gpio::setBackend(argument))
+            {
+                std::cerr << "No valid GPIO backend argument found!"
+                          << std::endl;
+
+                error = isp::ISP_INVALID_ARGUMENT;
+                break;
+            }
+            else
+            {
+                index = -1;
+            }
+        }
+
+        if (cmdLine.find("--profile", index) ||
+            cmdLine.find("-P", index))
+        {
+            const isp::GpioProfile * pProfile = nullptr;
+
+            if (!cmdLine.get(index + 1, argument) ||
+                (pProfile = isp::Gpio::findProfile(argument.c_str())) == nullptr)
+            {
+                std::cerr << "No valid reset profile argument found!"
+                          << std::endl;
+
+                error = isp::ISP_INVALID_ARGUMENT;
+                break;
+            }
+            else
+            {
+                isp::Gpio::setProfile(*pProfile);
+                index = -1;
+            }
+        }
+
         if (cmdLine.find("--examine", index) ||
             cmdLine.find("-x", index))
         {
             gOption |= EXAMINE_OPTION;
             index = -1;
         }
+
+        if (cmdLine.find("--cache", index) ||
+            cmdLine.find("-c", index))
+        {
+            if (!cmdLine.get(index + 1, argument))
+            {
+                std::cerr << "No cache directory argument found!"
+                          << std::endl;
+
+                error = isp::ISP_INVALID_ARGUMENT;
+                break;
+            }
+            else
+            {
+                gCacheDirectory = argument;
+                index = -1;
+            }
+        }
     } while (false);
 
     return;
@@ -472,12 +647,24 @@ int main(int argc,
                 std::cerr << "  --program  | -p    Program the flash"               << std::endl;
                 std::cerr << "  --test     | -t    Program the flash (dry-run)"     << std::endl;
                 std::cerr << "  --device   | -d    Serial port device name"         << std::endl;
+                std::cerr << "                     (dev1,dev2,... programs a gang)" << std::endl;
                 std::cerr << "  --filename | -f    Intel Hex filename"              << std::endl;
                 std::cerr << " OPTIONS:"                                            << std::endl;
                 std::cerr << "  --reset    | -r    Mark reset as active HIGH"       << std::endl;
                 std::cerr << "  --nogpio   | -g    Don't use GPIO for RST, ISP"     << std::endl;
                 std::cerr << "  --verbose  | -v    Verbose messages"                << std::endl;
                 std::cerr << "  --examine  | -x    Examine memory"                  << std::endl;
+                std::cerr << "  --legacy   | -l    Program in 1 KB RAM stages"      << std::endl;
+                std::cerr << "  --full     | -F    Program sectors that match too"  << std::endl;
+                std::cerr << "  --baud     | -b    Highest baud rate to negotiate"  << std::endl;
+                std::cerr << "  --lowlatency | -L  Low-latency serial driver mode"  << std::endl;
+                std::cerr << "  --rtscts   | -R    RTS/CTS flow control"            << std::endl;
+                std::cerr << "  --pipeline | -w    Send write data with its command" << std::endl;
+                std::cerr << "  --gpio     | -G    GPIO backend"                    << std::endl;
+                std::cerr << "                     (" << isp::GpioBackend::getNames() << ")" << std::endl;
+                std::cerr << "  --profile  | -P    Reset timing profile"            << std::endl;
+                std::cerr << "                     (" << isp::Gpio::getProfileNames() << ")" << std::endl;
+                std::cerr << "  --cache    | -c    Directory of prepared images"    << std::endl;
                 std::cerr << "  --help     | -h    Show this help"                  << std::endl;
                 exit(0);
             }
@@ -505,28 +692,10 @@ int main(int argc,
         isp::Signal sigTerm(SIGTERM, termHandler);
         isp::Alarm  alarm(alarmHandler, 50U);
         isp::Signal sigPipe(SIGPIPE);
-        bool        isDone = false;
 
         // Setup the LED output
         gLEDPtr = new isp::LED;
 
-        if (gOption & ERASE_OPTION)
-        {
-            // Start the erase thread
-            std::thread clientThread(eraseWorker, gSerialDevice.c_str());
-            isDone = false;
-
-            // Update the periodic interval
-            while (gQuit == false && isDone == false)
-            {
-                if (clientThread.joinable())
-                {
-                    clientThread.join();
-                    isDone = true;
-                }
-            }
-        }
-
         if ((gOption & PROGRAM_OPTION) ||
             (gOption & TEST_OPTION)    ||
             (gOption & EXAMINE_OPTION))
@@ -540,42 +709,38 @@ int main(int argc,
             {
                 LOG(ERROR) << "Error return from file worker thread: "
                              << fileWorkerStatus;
+                returnCode = 1;
                 break;
             }
         }
 
+        // Build the session pipeline
+        unsigned steps = 0U;
+        if (gOption & ERASE_OPTION)
+            steps |= isp::Session::STEP_ERASE;
         if (gOption & PROGRAM_OPTION)
-        {
-            // Start the program thread
-            std::thread clientThread(clientWorker, gSerialDevice.c_str());
-            isDone = false;
+            steps |= isp::Session::STEP_PROGRAM;
+        if (gOption & EXAMINE_OPTION)
+            steps |= isp::Session::STEP_VERIFY;
 
-            // Update the periodic interval
-            while (gQuit == false && isDone == false)
-            {
-                if (clientThread.joinable())
-                {
-                    clientThread.join();
-                    isDone = true;
-                }
-            }
-        }
+        // A comma separated device list selects gang mode
+        std::vector<std::string> devices;
+        isp::Utility::split(gSerialDevice, ",", devices);
 
-        if (gOption & EXAMINE_OPTION)
+        if (steps && devices.size() > 1)
         {
-            // Start the program thread
-            std::thread examineThread(examineWorker, gSerialDevice.c_str());
-            isDone = false;
-
-            // Update the periodic interval
-            while (gQuit == false && isDone == false)
-            {
-                if (examineThread.joinable())
-                {
-                    examineThread.join();
-                    isDone = true;
-                }
-            }
+            if (gangWorker(devices, steps | isp::Session::STEP_RUN) != 0)
+                returnCode = 1;
+        }
+        else if (steps)
+        {
+            // Start the session thread
+            std::future<int> sessionThread = std::async(std::launch::async,
+                                                        sessionWorker,
+                                                        gSerialDevice.c_str(),
+                                                        steps | isp::Session::STEP_RUN);
+            if (sessionThread.get() != 0)
+                returnCode = 1;
         }
 
         LOG (INFO) << "Tearing down...";
@@ -0,0 +1,174 @@
+///
+/// @file   Metrics.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <iomanip>
+#include <sstream>
+#include "Metrics.hh"
+
+
+//  Static variables
+static const char * sPhaseNames[ isp::Metrics::PHASE_COUNT ] =
+{
+    "reset",
+    "sync",
+    "baud",
+    "compare",
+    "blank_check",
+    "erase",
+    "ram_write",
+    "copy",
+    "verify"
+};
+
+static const char * sCounterNames[ isp::Metrics::COUNTER_COUNT ] =
+{
+    "sync_probes",
+    "sync_latency_us",
+    "reset_skipped",
+    "retries",
+    "bytes_written"
+};
+
+
+//
+//  @brief      Explicit constructor for the Timer class.
+//
+isp::Metrics::Timer::Timer(isp::Metrics& metrics, isp::Metrics::Phase phase)
+        : mMetrics(metrics),
+          mPhase(phase)
+{
+    clock_gettime(CLOCK_MONOTONIC, &mStart);
+}
+
+
+//
+//  @brief      Destructor; adds the elapsed time to the phase.
+//
+isp::Metrics::Timer::~Timer()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    mMetrics.add(mPhase, static_cast<uint64_t>(now.tv_sec - mStart.tv_sec) * 1000000000ULL +
+                         now.tv_nsec - mStart.tv_nsec);
+}
+
+
+//
+//  @brief      Default constructor for the Metrics class.
+//
+isp::Metrics::Metrics()
+{
+    clear();
+}
+
+
+//
+//  @brief      Clear every phase.
+//
+void isp::Metrics::clear()
+{
+    for (unsigned ii = 0; ii < PHASE_COUNT; ++ii)
+        mTimeInNS[ ii ] = 0U;
+    for (unsigned ii = 0; ii < COUNTER_COUNT; ++ii)
+        mCounts[ ii ] = 0U;
+}
+
+
+//
+//  @brief      Add time to a phase.
+//
+void isp::Metrics::add(isp::Metrics::Phase phase, uint64_t timeInNS)
+{
+    if (phase < PHASE_COUNT)
+        mTimeInNS[ phase ] += timeInNS;
+}
+
+
+//
+//  @brief      Add to a counter.
+//
+void isp::Metrics::count(isp::Metrics::Counter counter, uint64_t value)
+{
+    if (counter < COUNTER_COUNT)
+        mCounts[ counter ] += value;
+}
+
+
+//
+//  @brief      Get the value of a counter.
+//
+uint64_t isp::Metrics::getCount(isp::Metrics::Counter counter) const
+{
+    return (counter < COUNTER_COUNT)? mCounts[ counter ]: 0U;
+}
+
+
+//
+//  @brief      Get the time spent in a phase.
+//
+double isp::Metrics::getMS(isp::Metrics::Phase phase) const
+{
+    return (phase < PHASE_COUNT)? (mTimeInNS[ phase ] / 1.0e6): 0.0;
+}
+
+
+//
+//  @brief      Get the name of a phase.
+//
+const char * isp::Metrics::getName(isp::Metrics::Phase phase)
+{
+    return (phase < PHASE_COUNT)? sPhaseNames[ phase ]: "unknown";
+}
+
+
+//
+//  @brief      Get the name of a counter.
+//
+const char * isp::Metrics::getName(isp::Metrics::Counter counter)
+{
+    return (counter < COUNTER_COUNT)? sCounterNames[ counter ]: "unknown";
+}
+
+
+//
+//  @brief      Format every phase as a JSON object.
+//
+std::string isp::Metrics::toJSON() const
+{
+    std::ostringstream json;
+
+    json << "{" << std::fixed << std::setprecision(3);
+    for (unsigned ii = 0; ii < PHASE_COUNT; ++ii)
+    {
+        Phase phase = static_cast<Phase>(ii);
+
+        json << (ii? ",": "") << "\"" << getName(phase) << "\":" << getMS(phase);
+    }
+    json << "}";
+    return json.str();
+}
+
+
+//
+//  @brief      Format every counter as a JSON object.
+//
+std::string isp::Metrics::countersToJSON() const
+{
+    std::ostringstream json;
+
+    json << "{";
+    for (unsigned ii = 0; ii < COUNTER_COUNT; ++ii)
+    {
+        Counter counter = static_cast<Counter>(ii);
+
+        json << (ii? ",": "") << "\"" << getName(counter) << "\":" << getCount(counter);
+    }
+    json << "}";
+    return json.str();
+}
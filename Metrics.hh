@@ -0,0 +1,185 @@
+///
+/// @file   Metrics.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef METRICS_HH_
+#define METRICS_HH_
+
+//  Includes
+#include <stdint.h>
+#include <time.h>
+#include <string>
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Per-phase timing for one ISP session.
+///
+/// @details    This class accumulates the wall time spent in each phase of
+///             a job so that the cost of a change in the client or the
+///             protocol layer can be measured.
+///
+class Metrics
+{
+public:
+    typedef enum {
+        PHASE_RESET,            ///< Reset into ISP mode
+        PHASE_SYNC,             ///< Autobaud synchronization
+        PHASE_BAUD,             ///< Baud rate negotiation
+        PHASE_COMPARE,          ///< Sector CRC comparison for delta programming
+        PHASE_BLANK_CHECK,      ///< Blank check
+        PHASE_ERASE,            ///< Sector prepare and erase
+        PHASE_RAM_WRITE,        ///< Image transfer into RAM
+        PHASE_COPY,             ///< Sector prepare and RAM to flash copy
+        PHASE_VERIFY,           ///< Verification of flash against the image
+        PHASE_COUNT
+    } Phase;
+
+    typedef enum {
+        COUNTER_SYNC_PROBES,        ///< '?' probes sent before the target answered
+        COUNTER_SYNC_LATENCY,       ///< Microseconds from the first probe to the answer
+        COUNTER_RESET_SKIPPED,      ///< Resets skipped for a target already in ISP mode
+        COUNTER_RETRIES,            ///< Commands and sectors sent again after a failure
+        COUNTER_BYTES_WRITTEN,      ///< Data bytes written to target RAM
+        COUNTER_COUNT
+    } Counter;
+
+    ///
+    /// @brief      Scoped timer for one phase.
+    ///
+    /// @details    The time from construction to destruction is added to
+    ///             the phase.
+    ///
+    class Timer
+    {
+    public:
+        ///
+        /// @brief      Explicit constructor for the Timer class.
+        ///
+        /// @param[in]  metrics
+        ///             Reference to the metrics to add to.
+        ///
+        /// @param[in]  phase
+        ///             The phase being timed.
+        ///
+        Timer(Metrics& metrics, Phase phase);
+
+        ///
+        /// @brief      Destructor; adds the elapsed time to the phase.
+        ///
+        ~Timer();
+
+    private:
+        Timer() = delete;
+        Timer(const Timer& ref) = delete;
+        Timer& operator = (const Timer& ref) = delete;
+
+        // Data members
+        Metrics&        mMetrics;
+        Phase           mPhase;
+        struct timespec mStart;
+    };
+
+    ///
+    /// @brief      Default constructor for the Metrics class.
+    ///
+    Metrics();
+
+    ///
+    /// @brief      Default destructor for the Metrics class.
+    ///
+    ~Metrics() {}
+
+    ///
+    /// @brief      Clear every phase.
+    ///
+    void clear();
+
+    ///
+    /// @brief      Add time to a phase.
+    ///
+    /// @param[in]  phase
+    ///             The phase to add to.
+    ///
+    /// @param[in]  timeInNS
+    ///             The time in nanoseconds.
+    ///
+    void add(Phase phase, uint64_t timeInNS);
+
+    ///
+    /// @brief      Add to a counter.
+    ///
+    /// @param[in]  counter
+    ///             The counter to add to.
+    ///
+    /// @param[in]  value
+    ///             The amount to add.
+    ///
+    void count(Counter counter, uint64_t value = 1U);
+
+    ///
+    /// @brief      Get the value of a counter.
+    ///
+    /// @param[in]  counter
+    ///             The counter to get.
+    ///
+    /// @return     The accumulated value.
+    ///
+    uint64_t getCount(Counter counter) const;
+
+    ///
+    /// @brief      Get the time spent in a phase.
+    ///
+    /// @param[in]  phase
+    ///             The phase to get.
+    ///
+    /// @return     The accumulated time in milliseconds.
+    ///
+    double getMS(Phase phase) const;
+
+    ///
+    /// @brief      Get the name of a phase.
+    ///
+    /// @param[in]  phase
+    ///             The phase to name.
+    ///
+    /// @return     The name used in reports.
+    ///
+    static const char * getName(Phase phase);
+
+    ///
+    /// @brief      Get the name of a counter.
+    ///
+    /// @param[in]  counter
+    ///             The counter to name.
+    ///
+    /// @return     The name used in reports.
+    ///
+    static const char * getName(Counter counter);
+
+    ///
+    /// @brief      Format every phase as a JSON object.
+    ///
+    /// @return     The phase times in milliseconds, keyed by phase name.
+    ///
+    std::string toJSON() const;
+
+    ///
+    /// @brief      Format every counter as a JSON object.
+    ///
+    /// @return     The counter values keyed by counter name.
+    ///
+    std::string countersToJSON() const;
+
+private:
+    // Data members
+    uint64_t        mTimeInNS[ PHASE_COUNT ];
+    uint64_t        mCounts[ COUNTER_COUNT ];
+};  // class
+
+} // namespace
+#endif
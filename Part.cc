@@ -0,0 +1,76 @@
+///
+/// @file   Part.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include "Part.hh"
+
+
+//  Definitions
+#define KB(n)               ((n) * 1024U)
+
+//  The bootloader keeps its stack at the top of RAM and its work area
+//  below 0x02001000, so staging starts at 0x02001000 and stops short of
+//  the top of RAM.
+#define ISP_RAM_START       (0x02001000U)
+#define ISP_STACK_RESERVE   (0x200U)
+
+#define LPC15XX(id, name, flashKB, ramKB)                       \
+    { id, name, KB(flashKB), KB(flashKB) / KB(4), KB(ramKB),    \
+      ISP_RAM_START,                                            \
+      isp::Part::RAM_BASE + KB(ramKB) - ISP_STACK_RESERVE,      \
+      KB(4) }
+
+
+//  Static variables
+static constexpr isp::PartInfo sParts[] =
+{
+    LPC15XX(0x00001549, "LPC1549", 256, 36),
+    LPC15XX(0x00001548, "LPC1548", 128, 20),
+    LPC15XX(0x00001547, "LPC1547",  64, 12),
+    LPC15XX(0x00001519, "LPC1519", 256, 36),
+    LPC15XX(0x00001518, "LPC1518", 128, 20),
+    LPC15XX(0x00001517, "LPC1517",  64, 12)
+};
+
+static constexpr size_t sPartCount = sizeof(sParts) / sizeof(sParts[0]);
+
+
+//
+//  @brief      Check that every entry can stage a whole sector.
+//
+static constexpr bool isValid(size_t index)
+{
+    return (index >= sPartCount) ||
+           ((sParts[ index ].sectorCount * isp::Part::SECTOR_SIZE == sParts[ index ].flashSize) &&
+            (sParts[ index ].ramEnd - sParts[ index ].ramStart >= sParts[ index ].maxCopySize) &&
+            isValid(index + 1));
+}
+
+static_assert(isValid(0), "LPC15xx part table geometry is inconsistent");
+
+
+//
+//  @brief      Find the part for a chip identifier.
+//
+const isp::PartInfo * isp::Part::find(uint32_t id)
+{
+    for (size_t ii = 0; ii < sPartCount; ++ii)
+    {
+        if (sParts[ ii ].id == id)
+            return &sParts[ ii ];
+    }
+    return nullptr;
+}
+
+
+//
+//  @brief      Get the part to assume for an unknown identifier.
+//
+const isp::PartInfo& isp::Part::getDefault()
+{
+    return sParts[ 0 ];
+}
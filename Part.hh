@@ -0,0 +1,89 @@
+///
+/// @file   Part.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef PART_HH_
+#define PART_HH_
+
+//  Includes
+#include <stdint.h>
+#include <stddef.h>
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Flash and RAM geometry for one LPC15xx variant.
+///
+struct PartInfo
+{
+    uint32_t        id;             ///< Part identifier from the 'J' command
+    const char *    name;           ///< Part name
+    uint32_t        flashSize;      ///< Flash size in bytes
+    unsigned        sectorCount;    ///< Number of flash sectors
+    uint32_t        ramSize;        ///< On-chip SRAM size in bytes
+    uint32_t        ramStart;       ///< First RAM address free for ISP writes
+    uint32_t        ramEnd;         ///< End (exclusive) of the ISP RAM window
+    uint32_t        maxCopySize;    ///< Largest RAM to flash copy in bytes
+};
+
+///
+/// @brief      Part database for the LPC15xx family.
+///
+/// @details    This class looks up the geometry of the target from the
+///             part identifier returned by the bootloader.
+///
+class Part
+{
+public:
+    static const uint32_t RAM_BASE      = 0x02000000;
+    static const uint32_t SECTOR_SIZE   = 4096;
+
+    ///
+    /// @brief      Find the part for a chip identifier.
+    ///
+    /// @param[in]  id
+    ///             The part identifier returned by ISP::queryId.
+    ///
+    /// @return     Pointer to the part entry, or nullptr if the part is
+    ///             not known.
+    ///
+    static const PartInfo * find(uint32_t id);
+
+    ///
+    /// @brief      Get the part to assume for an unknown identifier.
+    ///
+    /// @details    This is the largest member of the family, which matches
+    ///             the geometry used before parts were identified.
+    ///
+    /// @return     Reference to the default part entry.
+    ///
+    static const PartInfo& getDefault();
+
+    ///
+    /// @brief      Get the size of the ISP RAM window for a part.
+    ///
+    /// @param[in]  part
+    ///             Reference to the part entry.
+    ///
+    /// @return     The number of bytes available for RAM staging.
+    ///
+    static uint32_t ramWindow(const PartInfo& part)
+    {
+        return part.ramEnd - part.ramStart;
+    }
+
+private:
+    ///
+    /// @brief      Default constructor.
+    ///
+    /// @details    NOT USED
+    ///
+    Part() = delete;
+};  // class
+
+} // namespace
+#endif
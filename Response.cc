@@ -0,0 +1,197 @@
+///
+/// @file   Response.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <string.h>
+#include <algorithm>
+#include "Response.hh"
+
+
+//
+//  @brief      Explicit constructor for the Response class.
+//
+isp::Response::Response(unsigned lines,
+                        unsigned errorLines,
+                        uint8_t * pData,
+                        size_t dataBytes)
+        : mLines(lines),
+          mErrorLines(errorLines),
+          mpData(pData),
+          mDataBytes(pData? dataBytes: 0U)
+{
+    start(nullptr, 0U);
+}
+
+
+//
+//  @brief      Start parsing a new reply.
+//
+void isp::Response::start(const char * pEcho, size_t echoLength)
+{
+    mpEcho       = pEcho;
+    mEchoLength  = pEcho? echoLength: 0U;
+    mState       = mEchoLength? STATE_ECHO: STATE_STATUS;
+    mMatched     = 0U;
+    mLineLength  = 0U;
+    mStatus      = 0U;
+    mRemaining   = 0U;
+    mFieldCount  = 0U;
+    mValue       = 0U;
+    mDataSize    = 0U;
+}
+
+
+//
+//  @brief      Parse the next received bytes.
+//
+size_t isp::Response::parse(const uint8_t * pBuffer, size_t size)
+{
+    size_t used = 0U;
+
+    while ((used < size) && (mState != STATE_DONE))
+    {
+        if (mState == STATE_DATA)
+        {
+            // Raw bytes, which may include CR and LF
+            size_t count = std::min(size - used, mDataBytes - mDataSize);
+
+            memcpy(mpData + mDataSize, pBuffer + used, count);
+            mDataSize += count;
+            used += count;
+            if (mDataSize == mDataBytes)
+                mState = STATE_DONE;
+            continue;
+        }
+
+        uint8_t ch = pBuffer[ used++ ];
+
+        switch (mState)
+        {
+        case STATE_ECHO:
+            // Anything ahead of the echo is noise; start over on a mismatch
+            if (ch == static_cast<uint8_t>(mpEcho[ mMatched ]))
+                ++mMatched;
+            else
+                mMatched = (ch == static_cast<uint8_t>(mpEcho[ 0 ]))? 1U: 0U;
+
+            if (mMatched == mEchoLength)
+                mState = STATE_STATUS;
+            break;
+
+        case STATE_STATUS:
+            if (ch == '\n')
+            {
+                // Empty lines ahead of the return code do not count
+                if (mLineLength)
+                    endStatus();
+            }
+            else if (!addDigit(ch, mStatus))
+            {
+                // Noise must not read as a success
+                fail();
+            }
+            break;
+
+        case STATE_FIELDS:
+            if (ch == '\n')
+            {
+                if (mLineLength)
+                    endField();
+                else
+                    fail();
+            }
+            else if (!addDigit(ch, mValue))
+            {
+                fail();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+    return used;
+}
+
+
+//
+//  @brief      Add raw data written into the data span.
+//
+void isp::Response::commitData(size_t size)
+{
+    if (mState != STATE_DATA)
+        return;
+
+    mDataSize += std::min(size, mDataBytes - mDataSize);
+    if (mDataSize == mDataBytes)
+        mState = STATE_DONE;
+}
+
+
+//
+//  @brief      Move on from the end of the return code line.
+//
+void isp::Response::endStatus()
+{
+    mRemaining = (mStatus == 0U)? mLines: mErrorLines;
+    mValue = 0U;
+    mLineLength = 0U;
+
+    if (mRemaining)
+        mState = STATE_FIELDS;
+    else if ((mStatus == 0U) && mDataBytes)
+        mState = STATE_DATA;
+    else
+        mState = STATE_DONE;
+}
+
+
+//
+//  @brief      Move on from the end of a line after the return code.
+//
+void isp::Response::endField()
+{
+    if (mFieldCount < MAX_FIELDS)
+        mFields[ mFieldCount++ ] = mValue;
+    mValue = 0U;
+    mLineLength = 0U;
+
+    if (--mRemaining)
+        return;
+
+    if ((mStatus == 0U) && mDataBytes)
+        mState = STATE_DATA;
+    else
+        mState = STATE_DONE;
+}
+
+
+//
+//  @brief      Add one character to a decimal line.
+//
+bool isp::Response::addDigit(uint8_t ch, uint32_t& value)
+{
+    if (ch == '\r')
+        return true;
+
+    if ((ch < '0') || (ch > '9') || (mLineLength >= MAX_DIGITS))
+        return false;
+
+    value = (value * 10U) + (ch - '0');
+    ++mLineLength;
+    return true;
+}
+
+
+//
+//  @brief      End the reply as unreadable.
+//
+void isp::Response::fail()
+{
+    mStatus = BAD_STATUS;
+    mState = STATE_DONE;
+}
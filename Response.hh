@@ -0,0 +1,219 @@
+///
+/// @file   Response.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef RESPONSE_HH_
+#define RESPONSE_HH_
+
+//  Includes
+#include <stdint.h>
+#include <stddef.h>
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Incremental parser for the reply to one ISP command.
+///
+/// @details    A reply is the optional command echo, a CR-LF terminated
+///             return code and, on success, a number of CR-LF terminated
+///             decimal lines and raw data bytes.  A failure can carry its
+///             own number of lines.  Bytes are fed in as they arrive, in
+///             any split, and are never copied except for the raw data,
+///             which goes straight to the buffer of the caller.
+///
+class Response
+{
+public:
+    static const unsigned MAX_FIELDS = 4;
+    static const unsigned BAD_STATUS = 0xFFFFFFFFU;     ///< Unreadable reply
+    static const unsigned MAX_DIGITS = 10;              ///< Digits in a 32-bit value
+
+    ///
+    /// @brief      Explicit constructor for the Response class.
+    ///
+    /// @param[in]  lines
+    ///             The number of lines following a success code.
+    ///
+    /// @param[in]  errorLines
+    ///             The number of lines following a failure code.
+    ///
+    /// @param[out] pData
+    ///             The buffer for the raw data of a successful reply.
+    ///
+    /// @param[in]  dataBytes
+    ///             The number of raw bytes following a success code.
+    ///
+    explicit Response(unsigned lines = 0U,
+                      unsigned errorLines = 0U,
+                      uint8_t * pData = nullptr,
+                      size_t dataBytes = 0U);
+
+    ///
+    /// @brief      Default destructor for the Response class.
+    ///
+    ~Response() {}
+
+    ///
+    /// @brief      Start parsing a new reply.
+    ///
+    /// @param[in]  pEcho
+    ///             The echoed command to skip; nullptr when echo is off.
+    ///             It must stay valid until the reply is done.
+    ///
+    /// @param[in]  echoLength
+    ///             The length of the echoed command.
+    ///
+    void start(const char * pEcho, size_t echoLength);
+
+    ///
+    /// @brief      Parse the next received bytes.
+    ///
+    /// @details    Bytes ahead of the echo are skipped, as are empty lines
+    ///             ahead of the return code.  Parsing stops at the end of
+    ///             the reply so that any bytes after it are left alone.
+    ///
+    /// @param[in]  pBuffer
+    ///             The received bytes.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    /// @return     The number of bytes taken by the reply.
+    ///
+    size_t parse(const uint8_t * pBuffer, size_t size);
+
+    ///
+    /// @brief      Determine if the reply is complete.
+    ///
+    /// @return     Boolean true once every part of the reply is parsed.
+    ///
+    bool isDone() const { return mState == STATE_DONE; }
+
+    ///
+    /// @brief      Get the return code.
+    ///
+    /// @return     The return code; valid once the reply is done.  It is
+    ///             BAD_STATUS if the return code or a line after it held
+    ///             anything but decimal digits, or none at all.
+    ///
+    unsigned getStatus() const { return mStatus; }
+
+    ///
+    /// @brief      Get the number of lines kept.
+    ///
+    /// @return     The number of lines, at most MAX_FIELDS.
+    ///
+    unsigned getFieldCount() const { return mFieldCount; }
+
+    ///
+    /// @brief      Get a line following the return code.
+    ///
+    /// @param[in]  index
+    ///             The line index, from zero.
+    ///
+    /// @return     The decimal value of the line, or zero if there is none.
+    ///
+    uint32_t getField(unsigned index) const
+    {
+        return (index < mFieldCount)? mFields[ index ]: 0U;
+    }
+
+    ///
+    /// @brief      Get the number of raw data bytes received.
+    ///
+    /// @return     The number of bytes written to the data buffer.
+    ///
+    size_t getDataSize() const { return mDataSize; }
+
+    ///
+    /// @brief      Get the room left for raw data.
+    ///
+    /// @details    Once the reply reaches its raw data, the caller may read
+    ///             the rest straight into this room and commit it rather
+    ///             than pass it through parse.
+    ///
+    /// @param[out] size
+    ///             The number of bytes still expected; zero unless the
+    ///             reply is at its raw data.
+    ///
+    /// @return     Pointer to where the next data byte goes.
+    ///
+    uint8_t * getDataSpan(size_t& size) const
+    {
+        size = (mState == STATE_DATA)? (mDataBytes - mDataSize): 0U;
+        return mpData + mDataSize;
+    }
+
+    ///
+    /// @brief      Add raw data written into the data span.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes written; at most the span size.
+    ///
+    void commitData(size_t size);
+
+private:
+    typedef enum {
+        STATE_ECHO,             ///< Matching the echoed command
+        STATE_STATUS,           ///< Reading the return code line
+        STATE_FIELDS,           ///< Reading the lines after the return code
+        STATE_DATA,             ///< Copying the raw data
+        STATE_DONE
+    } State;
+
+    Response(const Response& ref) = delete;
+    Response& operator = (const Response& ref) = delete;
+
+    ///
+    /// @brief      Move on from the end of the return code line.
+    ///
+    void endStatus();
+
+    ///
+    /// @brief      Move on from the end of a line after the return code.
+    ///
+    void endField();
+
+    ///
+    /// @brief      Add one character to a decimal line.
+    ///
+    /// @param[in]  ch
+    ///             The character; CR is ignored.
+    ///
+    /// @param[in,out] value
+    ///             The value of the line so far.
+    ///
+    /// @return     Boolean false if the character is not a digit or there
+    ///             are too many digits.
+    ///
+    bool addDigit(uint8_t ch, uint32_t& value);
+
+    ///
+    /// @brief      End the reply as unreadable.
+    ///
+    void fail();
+
+    // Data members
+    unsigned        mLines;
+    unsigned        mErrorLines;
+    uint8_t *       mpData;
+    size_t          mDataBytes;
+    const char *    mpEcho;
+    size_t          mEchoLength;
+    State           mState;
+    size_t          mMatched;
+    size_t          mLineLength;
+    uint32_t        mStatus;
+    unsigned        mRemaining;
+    unsigned        mFieldCount;
+    uint32_t        mValue;
+    uint32_t        mFields[ MAX_FIELDS ];
+    size_t          mDataSize;
+};  // class
+
+} // namespace
+#endif
@@ -0,0 +1,97 @@
+///
+/// @file   RingBuffer.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <string.h>
+#include <algorithm>
+#include "RingBuffer.hh"
+
+
+//
+//  @brief      Explicit constructor for the RingBuffer class.
+//
+isp::RingBuffer::RingBuffer(size_t capacity)
+        : mMask(0U),
+          mHead(0U),
+          mTail(0U)
+{
+    size_t size = 1U;
+
+    while (size < capacity)
+        size <<= 1;
+
+    mBuffer.resize(size);
+    mMask = size - 1;
+}
+
+
+//
+//  @brief      Get the oldest contiguous run of held bytes.
+//
+isp::RingBuffer::Span isp::RingBuffer::getReadSpan()
+{
+    size_t offset = mHead & mMask;
+    Span   span = { mBuffer.data() + offset,
+                    std::min(getSize(), mBuffer.size() - offset) };
+
+    return span;
+}
+
+
+//
+//  @brief      Get the first contiguous run of free bytes.
+//
+isp::RingBuffer::Span isp::RingBuffer::getWriteSpan()
+{
+    size_t offset = mTail & mMask;
+    Span   span = { mBuffer.data() + offset,
+                    std::min(getFree(), mBuffer.size() - offset) };
+
+    return span;
+}
+
+
+//
+//  @brief      Add bytes written into the write span.
+//
+void isp::RingBuffer::commit(size_t size)
+{
+    mTail += std::min(size, getFree());
+}
+
+
+//
+//  @brief      Drop bytes from the front of the buffer.
+//
+void isp::RingBuffer::consume(size_t size)
+{
+    mHead += std::min(size, getSize());
+
+    // Start over at the front so the next fill is one span
+    if (mHead == mTail)
+        clear();
+}
+
+
+//
+//  @brief      Copy bytes out of the buffer and consume them.
+//
+size_t isp::RingBuffer::read(uint8_t * pBuffer, size_t size)
+{
+    size_t copied = 0U;
+
+    while (copied < size && !isEmpty())
+    {
+        Span   span = getReadSpan();
+        size_t count = std::min(span.size, size - copied);
+
+        memcpy(pBuffer + copied, span.pData, count);
+        consume(count);
+        copied += count;
+    }
+    return copied;
+}
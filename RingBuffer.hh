@@ -0,0 +1,162 @@
+///
+/// @file   RingBuffer.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef RINGBUFFER_HH_
+#define RINGBUFFER_HH_
+
+//  Includes
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      Byte ring buffer with contiguous span access.
+///
+/// @details    The storage is allocated once by the constructor.  Producers
+///             fill the free span in place and commit it; consumers read the
+///             data span in place and consume it.  The positions return to
+///             the start whenever the buffer empties, so a buffer drained
+///             after each fill always presents its data in one span.
+///
+class RingBuffer
+{
+public:
+    ///
+    /// @brief      Contiguous run of bytes inside the buffer.
+    ///
+    typedef struct
+    {
+        uint8_t *   pData;          ///< First byte of the run
+        size_t      size;           ///< Number of bytes in the run
+    } Span;
+
+    ///
+    /// @brief      Explicit constructor for the RingBuffer class.
+    ///
+    /// @param[in]  capacity
+    ///             The minimum capacity in bytes; rounded up to a power of
+    ///             two.
+    ///
+    explicit RingBuffer(size_t capacity);
+
+    ///
+    /// @brief      Default destructor for the RingBuffer class.
+    ///
+    ~RingBuffer() {}
+
+    ///
+    /// @brief      Get the number of bytes held.
+    ///
+    /// @return     The number of bytes that can be consumed.
+    ///
+    size_t getSize() const { return mTail - mHead; }
+
+    ///
+    /// @brief      Get the number of bytes free.
+    ///
+    /// @return     The number of bytes that can be committed.
+    ///
+    size_t getFree() const { return mBuffer.size() - getSize(); }
+
+    ///
+    /// @brief      Determine if the buffer is empty.
+    ///
+    /// @return     Boolean true if nothing is held.
+    ///
+    bool isEmpty() const { return mTail == mHead; }
+
+    ///
+    /// @brief      Get the oldest contiguous run of held bytes.
+    ///
+    /// @return     The span; its size is zero when the buffer is empty.
+    ///
+    Span getReadSpan();
+
+    ///
+    /// @brief      Get the first contiguous run of free bytes.
+    ///
+    /// @return     The span; its size is zero when the buffer is full.
+    ///
+    Span getWriteSpan();
+
+    ///
+    /// @brief      Add bytes written into the write span.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes written; at most the write span size.
+    ///
+    void commit(size_t size);
+
+    ///
+    /// @brief      Drop bytes from the front of the buffer.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes to drop; at most getSize.
+    ///
+    void consume(size_t size);
+
+    ///
+    /// @brief      Copy bytes out of the buffer and consume them.
+    ///
+    /// @param[out] pBuffer
+    ///             The buffer to copy into.
+    ///
+    /// @param[in]  size
+    ///             The size of the buffer.
+    ///
+    /// @return     The number of bytes copied.
+    ///
+    size_t read(uint8_t * pBuffer, size_t size);
+
+    ///
+    /// @brief      Drop every byte held.
+    ///
+    void clear() { mHead = mTail = 0U; }
+
+private:
+    ///
+    /// @brief      Default constructor.
+    ///
+    /// @details    Force the use of the explicit constructor by not
+    ///             allowing the default constructor to exist.
+    ///
+    RingBuffer() = delete;
+
+    ///
+    /// @brief      RingBuffer copy constructor (non-copyable)
+    ///
+    /// @details    Make the class non-copyable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a RingBuffer instance to copy from.
+    ///
+    RingBuffer(const RingBuffer& ref) = delete;
+
+    ///
+    /// @brief      RingBuffer assignment operator (not-assignable)
+    ///
+    /// @details    Make the class non-assignable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a RingBuffer instance to copy from.
+    ///
+    /// @return     New instance for the left-hand side of the expression.
+    ///
+    RingBuffer& operator = (const RingBuffer& ref) = delete;
+
+    // Data members
+    std::vector<uint8_t>    mBuffer;
+    size_t                  mMask;
+    size_t                  mHead;
+    size_t                  mTail;
+};  // class
+
+} // namespace
+#endif
@@ -8,11 +8,43 @@
 
 //  Includes
 #include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <linux/serial.h>
 #include "Serial.hh"
 #include "Log.hh"
 #include "Utility.hh"
 
 
+//  Static variables
+static const struct
+{
+    unsigned    baud;
+    speed_t     speed;
+} sSpeedTable[] =
+{
+    {    9600,    B9600 },
+    {   19200,   B19200 },
+    {   38400,   B38400 },
+    {   57600,   B57600 },
+    {  115200,  B115200 },
+    {  230400,  B230400 },
+    {  460800,  B460800 },
+    {  921600,  B921600 },
+};
+
+static const size_t sSpeedCount = sizeof(sSpeedTable) / sizeof(sSpeedTable[0]);
+
+//  Readable from Serial::cancel until Serial::resetCancel; shared by every port
+static int sCancelFD = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+
 //
 //  @brief      Explicit constructor for the Serial class.
 //
@@ -21,8 +53,16 @@ isp::Serial::Serial(const char * pDevice,
                     int inputFlags)
             : mError(0),
               mIsOpen(false),
-              mFileDes(-1)
+              mFileDes(-1),
+              mBaudRate(0U),
+              mRxBuffer(RxBufferSize),
+              mIsLowLatency(false),
+              mOldSerialFlags(-1),
+              mOldLatencyTimer(-1),
+              mFlowControl(FLOW_NONE)
 {
+    clock_gettime(CLOCK_MONOTONIC, &mTxDone);
+
     do
     {
         //  First, open a file descriptor to the serial port
@@ -52,15 +92,18 @@ isp::Serial::Serial(const char * pDevice,
         mNewSettings.c_cflag |= CLOCAL;             // Ignore modem control lines
         mNewSettings.c_cflag |= CREAD;              // Enable receiver
 
-        mNewSettings.c_iflag |= IGNBRK;             // Ignore break
-        mNewSettings.c_iflag |= IGNPAR;             // Ignore parity
-        mNewSettings.c_iflag |= (IXON | IXOFF);     // Use XON / XOFF for flow control
-
         mNewSettings.c_oflag = 0;                   // No post processing
         mNewSettings.c_lflag = 0;
 
         cfmakeraw(&mNewSettings);
 
+        // After cfmakeraw, which clears IXON but not IXOFF; no flow
+        // control until setFlowControl says otherwise
+        mNewSettings.c_iflag |= IGNBRK;             // Ignore break
+        mNewSettings.c_iflag |= IGNPAR;             // Ignore parity
+        mNewSettings.c_iflag &= ~(IXON | IXOFF | IXANY);
+        mNewSettings.c_cflag &= ~CRTSCTS;
+
         //  Non-canonical mode- read will wait until VMIN characters
         //  can be read and then return that number of characters.  Zero
         //  is returned on EOF.
@@ -74,6 +117,13 @@ isp::Serial::Serial(const char * pDevice,
         //  IMMEDIATELY
         tcsetattr(mFileDes, TCSANOW, &mNewSettings);
         mIsOpen = true;
+        mDevice = pDevice;
+
+        for (size_t ii = 0; ii < sSpeedCount; ++ii)
+        {
+            if (sSpeedTable[ ii ].speed == cfgetospeed(&mNewSettings))
+                mBaudRate = sSpeedTable[ ii ].baud;
+        }
     } while (false);
 }
 
@@ -89,6 +139,9 @@ isp::Serial::~Serial()
         //  Flush the Receiver Queue on the terminal
         tcflush(mFileDes, TCIFLUSH);
 
+        //  Put the driver latency settings back
+        setLowLatency(false);
+
         //  Reset the terminal attributes back to the original
         tcsetattr(mFileDes, TCSANOW, &mOldSettings);
 
@@ -101,136 +154,504 @@ isp::Serial::~Serial()
 
 
 //
-//  @brief      Read an input buffer from the Serial port.
+//  @brief      Determine if the host supports a baud rate.
 //
-ssize_t isp::Serial::read(char * buffer,
-                          size_t size,
-                          unsigned timeInMS,
-                          unsigned& readTime)
+bool isp::Serial::isBaudRate(unsigned baud)
 {
-    ssize_t result = -1;
-    ssize_t bytesRead = 0;
-    char *  pBuffer = buffer;
+    for (size_t ii = 0; ii < sSpeedCount; ++ii)
+    {
+        if (sSpeedTable[ ii ].baud == baud)
+            return true;
+    }
+    return false;
+}
+
+
+//
+//  @brief      Change the baud rate of the open port.
+//
+bool isp::Serial::setBaudRate(unsigned baud)
+{
+    bool isSet = false;
 
     do
     {
         if (!mIsOpen)
             break;
 
-        if (!pBuffer)
+        size_t ii = 0;
+        while (ii < sSpeedCount && sSpeedTable[ ii ].baud != baud)
+            ++ii;
+
+        if (ii == sSpeedCount)
             break;
 
-        if (size == 0)
+        struct termios settings = mNewSettings;
+        cfsetispeed(&settings, sSpeedTable[ ii ].speed);
+        cfsetospeed(&settings, sSpeedTable[ ii ].speed);
+
+        // Let the last command go out at the old rate
+        tcdrain(mFileDes);
+        if (tcsetattr(mFileDes, TCSANOW, &settings) < 0)
+        {
+            mError = -errno;
             break;
+        }
+
+        // Drop anything that arrived while the rates disagreed
+        tcflush(mFileDes, TCIFLUSH);
+        mRxBuffer.clear();
+        mNewSettings = settings;
+        mBaudRate = baud;
+        isSet = true;
+    } while (false);
+
+    return isSet;
+}
+
+
+//
+//  @brief      Set the flow control.
+//
+bool isp::Serial::setFlowControl(isp::Serial::FlowControl flowControl)
+{
+    if (!mIsOpen)
+        return false;
+
+    if (flowControl == mFlowControl)
+        return true;
+
+    struct termios settings = mNewSettings;
+
+    settings.c_iflag &= ~(IXON | IXOFF | IXANY);
+    settings.c_cflag &= ~CRTSCTS;
+    if (flowControl == FLOW_XONXOFF)
+        settings.c_iflag |= (IXON | IXOFF);
+    else if (flowControl == FLOW_RTSCTS)
+        settings.c_cflag |= CRTSCTS;
+
+    if (tcsetattr(mFileDes, TCSADRAIN, &settings) < 0)
+    {
+        mError = -errno;
+        return false;
+    }
+
+    mNewSettings = settings;
+    mFlowControl = flowControl;
+    return true;
+}
+
+
+//
+//  @brief      Explicit constructor; turns XON/XOFF off.
+//
+isp::Serial::BinaryScope::BinaryScope(isp::Serial& serial)
+        : mSerial(serial),
+          mFlowControl(serial.getFlowControl())
+{
+    if (mFlowControl == FLOW_XONXOFF)
+        mSerial.setFlowControl(FLOW_NONE);
+}
+
+
+//
+//  @brief      Destructor; puts the flow control back.
+//
+isp::Serial::BinaryScope::~BinaryScope()
+{
+    mSerial.setFlowControl(mFlowControl);
+}
+
+
+//
+//  @brief      Get the sysfs latency timer file of a USB serial adapter.
+//
+static std::string latencyTimerPath(const std::string& device)
+{
+    char * pPath = realpath(device.c_str(), nullptr);
+    std::string path;
+
+    if (pPath)
+    {
+        const char * pName = strrchr(pPath, '/');
+
+        path = std::string("/sys/class/tty/") + (pName? pName + 1: pPath) +
+               "/device/latency_timer";
+        free(pPath);
+    }
+    return path;
+}
+
+
+//
+//  @brief      Read the latency timer of a USB serial adapter.
+//
+static int readLatencyTimer(const std::string& path)
+{
+    int value = -1;
+    FILE * pFile = path.empty()? nullptr: fopen(path.c_str(), "r");
+
+    if (pFile)
+    {
+        if (fscanf(pFile, "%d", &value) != 1)
+            value = -1;
+        fclose(pFile);
+    }
+    return value;
+}
+
+
+//
+//  @brief      Write the latency timer of a USB serial adapter.
+//
+static bool writeLatencyTimer(const std::string& path, int value)
+{
+    FILE * pFile = path.empty()? nullptr: fopen(path.c_str(), "w");
+    bool isSet = false;
+
+    if (pFile)
+    {
+        isSet = (fprintf(pFile, "%d\n", value) > 0);
+        isSet = (fclose(pFile) == 0) && isSet;
+    }
+    return isSet;
+}
 
-        fd_set fdSet;
-        unsigned timeout = timeInMS;
-        readTime = 0U;
 
-        while (timeout)
+//
+//  @brief      Switch the driver low-latency settings.
+//
+bool isp::Serial::setLowLatency(bool enable)
+{
+    std::string path = latencyTimerPath(mDevice);
+    struct serial_struct serial;
+    bool isSet = false;
+
+    do
+    {
+        if (!mIsOpen || enable == mIsLowLatency)
+            break;
+
+        if (enable)
         {
-            FD_ZERO(&fdSet);
-            FD_SET(mFileDes, &fdSet);
-            struct timeval tv = { 0U, 1000U };
+            // Hand bytes to the reader as soon as they arrive
+            if (ioctl(mFileDes, TIOCGSERIAL, &serial) == 0)
+            {
+                mOldSerialFlags = serial.flags;
+                serial.flags |= ASYNC_LOW_LATENCY;
+                if (ioctl(mFileDes, TIOCSSERIAL, &serial) == 0)
+                    isSet = true;
+            }
+
+            // FTDI adapters batch for 16 ms unless told otherwise
+            mOldLatencyTimer = readLatencyTimer(path);
+            if (mOldLatencyTimer > LOW_LATENCY_TIMER &&
+                writeLatencyTimer(path, LOW_LATENCY_TIMER))
+                isSet = true;
 
-            result = select(mFileDes + 1, &fdSet, NULL, NULL, &tv);
-            if (result > 0)
+            // The reads poll first, so read() should return what is there
+            mNewSettings.c_cc[VTIME] = 0;
+            mNewSettings.c_cc[VMIN]  = 0;
+        }
+        else
+        {
+            if (mOldSerialFlags >= 0 && ioctl(mFileDes, TIOCGSERIAL, &serial) == 0)
             {
-                if (FD_ISSET(mFileDes, &fdSet))
-                {
-                    result = ::read(mFileDes, pBuffer, size);
-                    if (result < 0)
-                    {
-                        mError = -errno;
-                        return 0;
-                    }
-                    else if (result > 0)
-                    {
-                        if (!readTime)
-                        {
-                            readTime = timeout;
-                        }
-                        pBuffer += result;
-                        size -= result;
-                        bytesRead += result;
-                        timeout = timeInMS;
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
+                serial.flags = mOldSerialFlags;
+                ioctl(mFileDes, TIOCSSERIAL, &serial);
             }
-            else if (result < 0 )
+            if (mOldLatencyTimer > LOW_LATENCY_TIMER)
+                writeLatencyTimer(path, mOldLatencyTimer);
+
+            mOldSerialFlags = -1;
+            mOldLatencyTimer = -1;
+            mNewSettings.c_cc[VTIME] = 1;
+            mNewSettings.c_cc[VMIN]  = 0;
+            isSet = true;
+        }
+
+        tcsetattr(mFileDes, TCSANOW, &mNewSettings);
+        mIsLowLatency = enable;
+    } while (false);
+
+    return isSet;
+}
+
+
+//
+//  @brief      Describe the driver latency settings in use.
+//
+std::string isp::Serial::getLatency()
+{
+    struct serial_struct serial;
+    std::string description;
+    int timer = readLatencyTimer(latencyTimerPath(mDevice));
+
+    if (mIsOpen && ioctl(mFileDes, TIOCGSERIAL, &serial) == 0)
+        description = (serial.flags & ASYNC_LOW_LATENCY)? "low latency": "normal latency";
+    else
+        description = "latency flag not supported";
+
+    description += ", USB latency timer ";
+    description += (timer >= 0)? (std::to_string(timer) + " ms"): "not present";
+    description += ", VTIME " + std::to_string(mNewSettings.c_cc[VTIME]);
+    return description;
+}
+
+
+//
+//  @brief      Get the nanoseconds from one monotonic time stamp to another.
+//
+static int64_t diffNS(const struct timespec& from, const struct timespec& to)
+{
+    return (static_cast<int64_t>(to.tv_sec - from.tv_sec) * 1000000000LL) +
+           (to.tv_nsec - from.tv_nsec);
+}
+
+
+//
+//  @brief      Move a monotonic time stamp on by a number of nanoseconds.
+//
+static void addNS(struct timespec& when, int64_t ns)
+{
+    ns += when.tv_nsec;
+    when.tv_sec += ns / 1000000000LL;
+    when.tv_nsec = ns % 1000000000LL;
+}
+
+
+//
+//  @brief      Cancel every wait on every port.
+//
+void isp::Serial::cancel()
+{
+    uint64_t one = 1U;
+
+    // Only write() here since this runs in signal handlers; it fails only
+    // when the counter is saturated, and then a cancel is already pending
+    if (sCancelFD >= 0 && ::write(sCancelFD, &one, sizeof(one)) < 0)
+        return;
+}
+
+
+//
+//  @brief      Let waits run again after a cancel.
+//
+void isp::Serial::resetCancel()
+{
+    uint64_t count;
+
+    // Reading an eventfd returns the counter and zeroes it; EAGAIN when
+    // there was no cancel to drain
+    if (sCancelFD >= 0 && ::read(sCancelFD, &count, sizeof(count)) < 0)
+        return;
+}
+
+
+//
+//  @brief      Determine if waits have been cancelled.
+//
+bool isp::Serial::isCancelled()
+{
+    struct pollfd pfd = { sCancelFD, POLLIN, 0 };
+
+    return (sCancelFD >= 0) && (poll(&pfd, 1, 0) > 0);
+}
+
+
+//
+//  @brief      Wait for a descriptor to become readable.
+//
+int isp::Serial::wait(int fd, const struct timespec& deadline)
+{
+    struct pollfd fds[ 2 ] = { { sCancelFD, POLLIN, 0 }, { fd, POLLIN, 0 } };
+    nfds_t count = (fd >= 0)? 2: 1;
+
+    for (;;)
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t remaining = diffNS(now, deadline);
+        if (remaining <= 0)
+            return 0;
+
+        struct timespec timeout = { static_cast<time_t>(remaining / 1000000000LL),
+                                    static_cast<long>(remaining % 1000000000LL) };
+
+        int result = ppoll(fds, count, &timeout, nullptr);
+        if (result > 0)
+        {
+            if (fds[ 0 ].revents)
             {
-                // Error
-                mError = -errno;
-                break;
+                errno = ECANCELED;
+                return -1;
             }
-            else if (result == 0)
+            return 1;
+        }
+        else if (result < 0 && errno != EINTR)
+        {
+            return -1;
+        }
+        else if (result == 0)
+        {
+            return 0;
+        }
+    }
+}
+
+
+//
+//  @brief      Account for the time written bytes spend on the wire.
+//
+void isp::Serial::addTxTime(size_t size)
+{
+    struct timespec now;
+
+    if (!mBaudRate)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (diffNS(mTxDone, now) > 0)
+        mTxDone = now;
+
+    // Ten bit times per byte: start, eight data bits and stop
+    addNS(mTxDone, static_cast<int64_t>(size) * 10LL * 1000000000LL / mBaudRate);
+}
+
+
+//
+//  @brief      Wait until everything written has left the wire.
+//
+void isp::Serial::drain()
+{
+    if (mIsOpen)
+    {
+        tcdrain(mFileDes);
+        wait(-1, mTxDone);
+    }
+}
+
+
+//
+//  @brief      Discard any input received and not yet read.
+//
+void isp::Serial::flush()
+{
+    if (mIsOpen)
+        tcflush(mFileDes, TCIFLUSH);
+    mRxBuffer.clear();
+}
+
+
+//
+//  @brief      Get the milliseconds elapsed since a monotonic time stamp.
+//
+static unsigned elapsedMS(const struct timespec& start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<unsigned>((now.tv_sec - start.tv_sec) * 1000 +
+                                 (now.tv_nsec - start.tv_nsec) / 1000000);
+}
+
+
+//
+//  @brief      Build a completion test for a number of lines.
+//
+isp::Serial::tFrameCheck isp::Serial::lines(unsigned count)
+{
+    unsigned found = 0U;
+    size_t   scanned = 1U;
+
+    // Only the bytes since the last call are scanned
+    return [count, found, scanned](const uint8_t * pBuffer, size_t size) mutable
+    {
+        for (; scanned < size; ++scanned)
+        {
+            if ((pBuffer[scanned - 1] == '\r') && (pBuffer[scanned] == '\n'))
             {
-                // Timeout
-                timeout--;
+                if (++found >= count)
+                    return true;
             }
         }
-    } while (false);
+        return false;
+    };
+}
 
-    if (!result && bytesRead)
-        result = bytesRead;
 
-    return result;
+//
+//  @brief      Build a completion test for a number of bytes.
+//
+isp::Serial::tFrameCheck isp::Serial::bytes(size_t count)
+{
+    return [count](const uint8_t *, size_t size)
+    {
+        return (size >= count);
+    };
 }
 
 
 //
-//  @brief      Read an input string from the Serial port.
+//  @brief      Read an input buffer from the Serial port.
 //
-ssize_t isp::Serial::read(std::string& str,
-                          unsigned timeoutInMS,
-                          unsigned& readTime,
-                          bool isVerbose)
+ssize_t isp::Serial::read(char * pBuffer,
+                          size_t size,
+                          unsigned timeInMS,
+                          unsigned& readTime)
 {
     ssize_t result = -1;
-    ssize_t bytesRead = 0;
-    size_t  size = isp::Serial::RxBufferSize;
 
     do
     {
         if (!mIsOpen)
             break;
 
+        if (!pBuffer)
+            break;
+
         if (size == 0)
             break;
 
-        char * pBuffer = new char[ size + 1 ];
-        if (!pBuffer)
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        readTime = 0U;
+        result = 0;
+
+        // The timeout runs from when the last byte written has left the
+        // wire, not from when it was queued
+        struct timespec deadline = (diffNS(start, mTxDone) > 0)? mTxDone: start;
+        addNS(deadline, static_cast<int64_t>(timeInMS) * 1000000LL);
+
+        // Wait for the line to become readable or for a cancel.  The alarm
+        // signal may interrupt the wait; the deadline stays where it is.
+        if ((result = wait(mFileDes, deadline)) > 0)
         {
-            mError = -ENOMEM;
-            break;
+            readTime = elapsedMS(start);
+            result = ::read(mFileDes, pBuffer, size);
+            if (result < 0)
+                mError = -errno;
         }
-
-        do
+        else if (result < 0)
         {
-            result = read(pBuffer, size, timeoutInMS, readTime);
-            if (result > 0 )
-            {
-                LOG(TRACE) << "Result: " << result  << "  Read time: " << readTime
-                           << " ms  timeout: " << timeoutInMS << " ms";
-                if (isVerbose)
-                    Utility::hexDump(reinterpret_cast<const uint8_t *>(pBuffer), result);
-                pBuffer[result] = '\0';
-                str += pBuffer;
-                pBuffer[0] = '\0';
-                bytesRead += result;
-            }
-        } while (result > 0);
+            mError = -errno;
+        }
+    } while (false);
 
-        delete[] pBuffer;
-        pBuffer = NULL;
+    return result;
+}
 
-    } while (false);
 
-    return bytesRead;
+//
+//  @brief      Read an input string from the Serial port.
+//
+ssize_t isp::Serial::read(std::string& str,
+                          unsigned timeoutInMS,
+                          unsigned& readTime,
+                          bool isVerbose)
+{
+    return read(str, tFrameCheck(), timeoutInMS, readTime, isVerbose);
 }
 
 
@@ -241,77 +662,206 @@ ssize_t isp::Serial::read(std::vector<uint8_t>& bVector,
                           unsigned timeoutInMS,
                           unsigned& readTime,
                           bool isVerbose )
+{
+    return read(bVector, tFrameCheck(), timeoutInMS, readTime, isVerbose);
+}
+
+
+//
+//  @brief      Read more input into the receive buffer.
+//
+ssize_t isp::Serial::fill(unsigned timeoutInMS,
+                          unsigned& readTime)
+{
+    isp::RingBuffer::Span span = mRxBuffer.getWriteSpan();
+
+    readTime = 0U;
+    if (span.size == 0)
+        return 0;
+
+    ssize_t result = read(reinterpret_cast<char *>(span.pData), span.size,
+                          timeoutInMS, readTime);
+    if (result > 0)
+        mRxBuffer.commit(result);
+    return result;
+}
+
+
+//
+//  @brief      Read input straight into a caller buffer.
+//
+ssize_t isp::Serial::fill(uint8_t * pBuffer,
+                          size_t size,
+                          unsigned timeoutInMS,
+                          unsigned& readTime)
+{
+    readTime = 0U;
+    if (!mRxBuffer.isEmpty())
+        return 0;
+
+    return read(reinterpret_cast<char *>(pBuffer), size, timeoutInMS, readTime);
+}
+
+
+//
+//  @brief      Read a framed response into a string or byte vector.
+//
+template <class T>
+ssize_t isp::Serial::readFrame(T& container,
+                               const tFrameCheck& isComplete,
+                               unsigned timeoutInMS,
+                               unsigned& readTime,
+                               bool isVerbose)
 {
     ssize_t result = -1;
     ssize_t bytesRead = 0;
-    size_t  size = isp::Serial::RxBufferSize;
+    size_t  first = container.size();
+
+    // A fresh copy, so a test that keeps scan state starts from nothing
+    tFrameCheck check = isComplete;
+
+    readTime = 0U;
 
     do
     {
         if (!mIsOpen)
             break;
 
-        if (size == 0)
-            break;
-
-        char * pBuffer = new char[ size + 1 ];
-        if (!pBuffer)
-        {
-            mError = -ENOMEM;
-            break;
-        }
-
         do
         {
-            result = read(pBuffer, size, timeoutInMS, readTime);
+            unsigned waitTime = 0U;
+
+            // Take what is already buffered before waiting on the line
+            if (mRxBuffer.isEmpty())
+                result = fill(timeoutInMS, waitTime);
+            else
+                result = mRxBuffer.getSize();
+
             if (result > 0 )
             {
+                if (!bytesRead)
+                    readTime = waitTime;
 
-                LOG(TRACE) << "Result: " << result  << "  Read time: " << readTime
+                LOG(TRACE) << "Result: " << result  << "  Read time: " << waitTime
                            << " ms  timeout: " << timeoutInMS << " ms";
-                if (isVerbose)
-                    Utility::hexDump(reinterpret_cast<const uint8_t *>(pBuffer), result);
-                pBuffer[result] = '\0';
-                for (int ii = 0; ii < result; ++ii)
+
+                // Move the buffered bytes over in whole spans
+                while (!mRxBuffer.isEmpty())
                 {
-                    bVector.push_back(static_cast<uint8_t>(pBuffer[ii]));
+                    isp::RingBuffer::Span span = mRxBuffer.getReadSpan();
+
+                    if (isVerbose)
+                        Utility::hexDump(span.pData, span.size);
+                    container.insert(container.end(), span.pData, span.pData + span.size);
+                    mRxBuffer.consume(span.size);
                 }
                 bytesRead += result;
+
+                // Stop as soon as the response is complete
+                if (check &&
+                    (container.size() > first) &&
+                    check(reinterpret_cast<const uint8_t *>(container.data()) + first,
+                          container.size() - first))
+                    break;
             }
         } while (result > 0);
 
-        delete[] pBuffer;
-        pBuffer = NULL;
-
     } while (false);
 
-    return bytesRead;
+    // A failed or cancelled wait is only an error if it left nothing
+    return ((bytesRead == 0) && (result < 0))? result: bytesRead;
 }
 
 
 //
-//  @brief      Write an output buffer to the Serial port.
+//  @brief      Read a framed response string from the Serial port.
 //
-ssize_t isp::Serial::write(const char * pBuffer, size_t size)
+ssize_t isp::Serial::read(std::string& str,
+                          const tFrameCheck& isComplete,
+                          unsigned timeoutInMS,
+                          unsigned& readTime,
+                          bool isVerbose)
 {
+    return readFrame(str, isComplete, timeoutInMS, readTime, isVerbose);
+}
+
+
+//
+//  @brief      Read a framed response byte-vector from the Serial port.
+//
+ssize_t isp::Serial::read(std::vector<uint8_t>& bVector,
+                          const tFrameCheck& isComplete,
+                          unsigned timeoutInMS,
+                          unsigned& readTime,
+                          bool isVerbose)
+{
+    return readFrame(bVector, isComplete, timeoutInMS, readTime, isVerbose);
+}
+
+
+//
+//  @brief      Write a gathered set of buffers to the Serial port.
+//
+ssize_t isp::Serial::write(const struct iovec * pIov,
+                           int count,
+                           bool isDrain)
+{
+    struct iovec iov[ MAX_IOV ];
     ssize_t result = -1;
+    ssize_t total = 0;
 
     do
     {
         if (!mIsOpen)
             break;
 
-        if (!pBuffer)
+        if (!pIov || count <= 0 || count > MAX_IOV)
             break;
 
-        if (size == 0)
-            break;
+        // Work on a copy so a short write can move the start along
+        int first = 0;
+        for (int ii = 0; ii < count; ++ii)
+            iov[ ii ] = pIov[ ii ];
 
-        result = ::write(mFileDes, pBuffer, size);
-        if (result < 0)
+        while (first < count)
         {
-            mError = -errno;
+            if (iov[ first ].iov_len == 0)
+            {
+                ++first;
+                continue;
+            }
+
+            ssize_t written = ::writev(mFileDes, iov + first, count - first);
+            if (written < 0)
+            {
+                if (errno == EINTR && !isCancelled())
+                    continue;
+
+                mError = -errno;
+                break;
+            }
+
+            addTxTime(written);
+            total += written;
+
+            while (written > 0)
+            {
+                size_t step = std::min(static_cast<size_t>(written), iov[ first ].iov_len);
+
+                iov[ first ].iov_base = static_cast<uint8_t *>(iov[ first ].iov_base) + step;
+                iov[ first ].iov_len -= step;
+                written -= step;
+                if (iov[ first ].iov_len == 0)
+                    ++first;
+            }
         }
+
+        if (first < count)
+            break;
+
+        if (isDrain)
+            drain();
+        result = total;
     } while (false);
 
     return result;
@@ -319,27 +869,25 @@ ssize_t isp::Serial::write(const char * pBuffer, size_t size)
 
 
 //
-//  @brief      Write an output string to the Serial port.
+//  @brief      Write an output buffer to the Serial port.
 //
-ssize_t isp::Serial::write(const std::string& str)
+ssize_t isp::Serial::write(const char * pBuffer, size_t size)
 {
-    ssize_t result = -1;
+    struct iovec iov = { const_cast<char *>(pBuffer), size };
 
-    do
-    {
-        if (!mIsOpen)
-            break;
+    if (!pBuffer || size == 0)
+        return -1;
 
-        const char * pBuffer = str.c_str();
+    return write(&iov, 1);
+}
 
-        result = ::write(mFileDes, pBuffer, str.length());
-        if (result < 0)
-        {
-            mError = -errno;
-        }
-    } while (false);
 
-    return result;
+//
+//  @brief      Write an output string to the Serial port.
+//
+ssize_t isp::Serial::write(const std::string& str)
+{
+    return write(str.data(), str.length());
 }
 
 
@@ -348,26 +896,7 @@ ssize_t isp::Serial::write(const std::string& str)
 //
 ssize_t isp::Serial::write(const std::vector<uint8_t>& vec)
 {
-    ssize_t result = -1;
-
-    do
-    {
-        if (!mIsOpen)
-            break;
-
-        if (!vec.size())
-            break;
-
-        const uint8_t * pVector = vec.data();
-
-        result = ::write(mFileDes, pVector, vec.size());
-        if (result < 0)
-        {
-            mError = -errno;
-        }
-    } while (false);
-
-    return result;
+    return write(reinterpret_cast<const char *>(vec.data()), vec.size());
 }
 
 
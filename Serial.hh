@@ -11,11 +11,17 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <errno.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "RingBuffer.hh"
 #include "Signal.hh"
 
 // Namespace
@@ -30,7 +36,79 @@ namespace isp {
 class Serial
 {
 public:
-    static const size_t RxBufferSize  = 2048;
+    static const size_t RxBufferSize  = 4096;
+    static const int    LOW_LATENCY_TIMER = 1;     ///< ms, for USB adapters
+    static const int    MAX_IOV = 8;               ///< Buffers in one gathered write
+
+    typedef enum {
+        FLOW_NONE,              ///< No flow control
+        FLOW_XONXOFF,           ///< XON/XOFF in band; text only
+        FLOW_RTSCTS             ///< RTS/CTS hardware handshake
+    } FlowControl;
+
+    ///
+    /// @brief      Scoped switch to a flow control safe for binary data.
+    ///
+    /// @details    XON/XOFF is turned off for the life of the scope since
+    ///             0x11 and 0x13 are ordinary bytes in binary data; RTS/CTS
+    ///             is left alone.
+    ///
+    class BinaryScope
+    {
+    public:
+        ///
+        /// @brief      Explicit constructor; turns XON/XOFF off.
+        ///
+        /// @param[in]  serial
+        ///             Reference to the port.
+        ///
+        explicit BinaryScope(Serial& serial);
+
+        ///
+        /// @brief      Destructor; puts the flow control back.
+        ///
+        ~BinaryScope();
+
+    private:
+        BinaryScope() = delete;
+        BinaryScope(const BinaryScope& ref) = delete;
+        BinaryScope& operator = (const BinaryScope& ref) = delete;
+
+        // Data members
+        Serial&         mSerial;
+        FlowControl     mFlowControl;
+    };
+
+    ///
+    /// @brief      Completion test for a framed read.
+    ///
+    /// @details    Called with every byte received so far by the read; it
+    ///             returns true once the response is complete so that the
+    ///             read returns at once instead of waiting for the line to
+    ///             go idle.  Each read calls its own copy, so a test may
+    ///             keep how far it has scanned and look only at new bytes.
+    ///
+    typedef std::function<bool (const uint8_t * pBuffer, size_t size)> tFrameCheck;
+
+    ///
+    /// @brief      Build a completion test for a number of lines.
+    ///
+    /// @param[in]  count
+    ///             The number of CR-LF terminated lines to wait for.
+    ///
+    /// @return     The completion test.
+    ///
+    static tFrameCheck lines(unsigned count);
+
+    ///
+    /// @brief      Build a completion test for a number of bytes.
+    ///
+    /// @param[in]  count
+    ///             The number of bytes to wait for.
+    ///
+    /// @return     The completion test.
+    ///
+    static tFrameCheck bytes(size_t count);
 
     ///
     /// @brief      Explicit constructor for the Serial class.
@@ -108,6 +186,147 @@ public:
                  unsigned& readTime,
                  bool isVerbose = false);
 
+    ///
+    /// @brief      Read a framed response string from the Serial port.
+    ///
+    /// @details    The read returns as soon as the completion test is
+    ///             satisfied.  The timeout only applies to silence on the
+    ///             line; every received byte restarts it.
+    ///
+    /// @param[out] str
+    ///             A reference to the string to write to.
+    ///
+    /// @param[in]  isComplete
+    ///             The completion test for the response.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The time in milliseconds for the reply timeout.
+    ///
+    /// @param[out] readTime
+    ///             The time in milliseconds until the first byte arrived.
+    ///
+    /// @param[in]  isVerbose
+    ///             Boolean flag for the debug verbosity.
+    ///
+    /// @return     The number of bytes read into the string.  Set to a
+    ///             negative number on error.
+    ///
+    ssize_t read(std::string& str,
+                 const tFrameCheck& isComplete,
+                 unsigned timeoutInMS,
+                 unsigned& readTime,
+                 bool isVerbose = false);
+
+    ///
+    /// @brief      Read a framed response byte vector from the Serial port.
+    ///
+    /// @details    The read returns as soon as the completion test is
+    ///             satisfied.  The timeout only applies to silence on the
+    ///             line; every received byte restarts it.
+    ///
+    /// @param[out] bVector
+    ///             A reference to the byte vector to write to.
+    ///
+    /// @param[in]  isComplete
+    ///             The completion test for the response.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The time in milliseconds for the reply timeout.
+    ///
+    /// @param[out] readTime
+    ///             The time in milliseconds until the first byte arrived.
+    ///
+    /// @param[in]  isVerbose
+    ///             Boolean flag for the debug verbosity.
+    ///
+    /// @return     The number of bytes read into the vector.  Set to a
+    ///             negative number on error.
+    ///
+    ssize_t read(std::vector<uint8_t>& bVector,
+                 const tFrameCheck& isComplete,
+                 unsigned timeoutInMS,
+                 unsigned& readTime,
+                 bool isVerbose = false);
+
+    ///
+    /// @brief      Read more input into the receive buffer.
+    ///
+    /// @details    Waits up to the timeout for the line to become readable
+    ///             and reads straight into the free span of the buffer.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The time in milliseconds for the reply timeout.
+    ///
+    /// @param[out] readTime
+    ///             The time in milliseconds until the first byte arrived.
+    ///
+    /// @return     The number of bytes added, zero on a timeout or when the
+    ///             buffer is full.  Set to a negative number on error.
+    ///
+    ssize_t fill(unsigned timeoutInMS,
+                 unsigned& readTime);
+
+    ///
+    /// @brief      Read input straight into a caller buffer.
+    ///
+    /// @details    For payloads of known length, so that they skip the
+    ///             receive buffer.  Nothing is read while the receive buffer
+    ///             holds data; that must be taken first to keep the order.
+    ///
+    /// @param[out] pBuffer
+    ///             The buffer to read into.
+    ///
+    /// @param[in]  size
+    ///             The most bytes to read.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The time in milliseconds for the reply timeout.
+    ///
+    /// @param[out] readTime
+    ///             The time in milliseconds until the first byte arrived.
+    ///
+    /// @return     The number of bytes read, zero on a timeout or when the
+    ///             receive buffer is not empty.  Set to a negative number on
+    ///             error.
+    ///
+    ssize_t fill(uint8_t * pBuffer,
+                 size_t size,
+                 unsigned timeoutInMS,
+                 unsigned& readTime);
+
+    ///
+    /// @brief      Get the receive buffer.
+    ///
+    /// @details    Bytes received but not yet taken by a read stay here;
+    ///             consumers may parse them in place through the spans of
+    ///             the buffer.
+    ///
+    /// @return     Reference to the receive buffer.
+    ///
+    isp::RingBuffer& getRxBuffer() { return mRxBuffer; }
+
+    ///
+    /// @brief      Write a gathered set of buffers to the Serial port.
+    ///
+    /// @details    The buffers go out with writev in as few calls as the
+    ///             driver allows; short writes and signals are retried
+    ///             until every byte is accepted.
+    ///
+    /// @param[in]  pIov
+    ///             Pointer to the buffers to write, in order.
+    ///
+    /// @param[in]  count
+    ///             The number of buffers, at most MAX_IOV.
+    ///
+    /// @param[in]  isDrain
+    ///             Wait until the bytes have left the wire when true.
+    ///
+    /// @return     The number of bytes written. Set to a negative number on error.
+    ///
+    ssize_t write(const struct iovec * pIov,
+                  int count,
+                  bool isDrain = false);
+
     ///
     /// @brief      Write an output buffer to the Serial port.
     ///
@@ -143,6 +362,118 @@ public:
     ///
     ssize_t write(const std::vector<uint8_t>& vec);
 
+    ///
+    /// @brief      Wait until everything written has left the wire.
+    ///
+    /// @details    Waits for the driver to drain and then for the estimated
+    ///             transmission time, since adapters and pseudo-terminals
+    ///             may report the output drained while it is still queued.
+    ///
+    void drain();
+
+    ///
+    /// @brief      Discard any input received and not yet read.
+    ///
+    void flush();
+
+    ///
+    /// @brief      Change the baud rate of the open port.
+    ///
+    /// @details    Output still queued is drained at the old rate first,
+    ///             and any input received before the change is discarded.
+    ///
+    /// @param[in]  baud
+    ///             The new baud rate.
+    ///
+    /// @return     Boolean true on success, false if the rate is not
+    ///             supported by the host or the adapter rejected it.
+    ///
+    bool setBaudRate(unsigned baud);
+
+    ///
+    /// @brief      Get the current baud rate of the port.
+    ///
+    /// @return     The baud rate, or zero if it is not a standard rate.
+    ///
+    unsigned getBaudRate() { return mBaudRate; }
+
+    ///
+    /// @brief      Determine if the host supports a baud rate.
+    ///
+    /// @param[in]  baud
+    ///             The baud rate to check.
+    ///
+    /// @return     Boolean true if the rate has a termios speed.
+    ///
+    static bool isBaudRate(unsigned baud);
+
+    ///
+    /// @brief      Set the flow control.
+    ///
+    /// @details    Output already queued goes out under the old setting.
+    ///
+    /// @param[in]  flowControl
+    ///             The flow control to use.
+    ///
+    /// @return     Boolean true on success.
+    ///
+    bool setFlowControl(FlowControl flowControl);
+
+    ///
+    /// @brief      Get the flow control.
+    ///
+    /// @return     The flow control in use.
+    ///
+    FlowControl getFlowControl() { return mFlowControl; }
+
+    ///
+    /// @brief      Switch the driver low-latency settings.
+    ///
+    /// @details    Sets ASYNC_LOW_LATENCY on the port, lowers the sysfs
+    ///             latency_timer of a USB adapter that has one (FTDI) to
+    ///             LOW_LATENCY_TIMER, and drops VTIME so that a read returns
+    ///             the moment the poll says data is there.  Turning it off,
+    ///             or closing the port, restores the earlier settings.
+    ///
+    /// @param[in]  enable
+    ///             Boolean true to turn low latency on.
+    ///
+    /// @return     Boolean true if any setting took effect.
+    ///
+    bool setLowLatency(bool enable);
+
+    ///
+    /// @brief      Describe the driver latency settings in use.
+    ///
+    /// @return     A readable summary read back from the driver.
+    ///
+    std::string getLatency();
+
+    ///
+    /// @brief      Cancel every wait on every port.
+    ///
+    /// @details    Safe to call from a signal handler.  Waits in progress
+    ///             return at once with ECANCELED, and so does every later
+    ///             wait until resetCancel, so that a quit is not held up by
+    ///             retries.  The cancel is process wide.
+    ///
+    static void cancel();
+
+    ///
+    /// @brief      Let waits run again after a cancel.
+    ///
+    /// @details    Call once the cancelled session has been torn down and
+    ///             before the next is opened in the same process.
+    ///
+    static void resetCancel();
+
+    ///
+    /// @brief      Determine if waits have been cancelled.
+    ///
+    /// @return     Boolean true from cancel until resetCancel.
+    ///
+    static bool isCancelled();
+
     ///
     /// @brief      Get the current error state.
     ///
@@ -190,6 +521,9 @@ private:
     ///
     /// @brief      Read an input buffer from the Serial port.
     ///
+    /// @details    Wait up to the timeout for the line to become readable
+    ///             and return whatever bytes are available at that point.
+    ///
     /// @param[out] pBuffer
     ///             A pointer to the user buffer to write to.
     ///
@@ -200,20 +534,90 @@ private:
     ///             The timeout value in milliseconds for the read.
     ///
     /// @param[out] readTime
-    ///             The time in milliseconds when reading starts.
+    ///             The time in milliseconds until the first byte arrived.
     ///
-    /// @return     The number of bytes read into the buffer.  Set to a
-    ///             negative number on error.
+    /// @return     The number of bytes read into the buffer, zero on a
+    ///             timeout.  Set to a negative number on error.
     ///
     ssize_t read(char * pBuffer,
                  size_t size,
                  unsigned timeInMS,
                  unsigned& readTime);
 
+    ///
+    /// @brief      Read a framed response into a string or byte vector.
+    ///
+    /// @details    Bytes are moved from the receive buffer a whole span at
+    ///             a time, so binary data is kept intact and nothing is
+    ///             allocated apart from the growth of the container.
+    ///
+    /// @param[out] container
+    ///             A reference to the string or byte vector to append to.
+    ///
+    /// @param[in]  isComplete
+    ///             The completion test for the response.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The time in milliseconds for the reply timeout.
+    ///
+    /// @param[out] readTime
+    ///             The time in milliseconds until the first byte arrived.
+    ///
+    /// @param[in]  isVerbose
+    ///             Boolean flag for the debug verbosity.
+    ///
+    /// @return     The number of bytes appended, or a negative number if
+    ///             nothing was read and the wait failed or was cancelled.
+    ///
+    template <class T>
+    ssize_t readFrame(T& container,
+                      const tFrameCheck& isComplete,
+                      unsigned timeoutInMS,
+                      unsigned& readTime,
+                      bool isVerbose);
+
+    ///
+    /// @brief      Wait for a descriptor to become readable.
+    ///
+    /// @details    Signals do not move the deadline, and a cancel ends the
+    ///             wait at once.
+    ///
+    /// @param[in]  fd
+    ///             The descriptor to wait on, or negative to wait only for
+    ///             the deadline or a cancel.
+    ///
+    /// @param[in]  deadline
+    ///             The CLOCK_MONOTONIC time to give up at.
+    ///
+    /// @return     One if readable, zero at the deadline, or negative with
+    ///             errno set on error or ECANCELED on a cancel.
+    ///
+    static int wait(int fd, const struct timespec& deadline);
+
+    ///
+    /// @brief      Account for the time written bytes spend on the wire.
+    ///
+    /// @details    A write returns as soon as the bytes are queued, so the
+    ///             estimated end of transmission is kept to stop reply
+    ///             timeouts expiring while a long write is still going out.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes written.
+    ///
+    void addTxTime(size_t size);
+
     // Data Members
     int             mError;
     bool            mIsOpen;
     int             mFileDes;
+    unsigned        mBaudRate;
+    struct timespec mTxDone;
+    isp::RingBuffer mRxBuffer;
+    std::string     mDevice;
+    bool            mIsLowLatency;
+    int             mOldSerialFlags;
+    int             mOldLatencyTimer;
+    FlowControl     mFlowControl;
     struct termios  mOldSettings;
     struct termios  mNewSettings;
 };
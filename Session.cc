@@ -0,0 +1,192 @@
+///
+/// @file   Session.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <iomanip>
+#include "Client.hh"
+#include "Log.hh"
+#include "Session.hh"
+
+
+// External References
+extern  bool        gQuit;
+extern  bool        gIsLowLatency;
+extern  bool        gIsRtsCts;
+extern  bool        gIsPipeline;
+
+
+//
+//  @brief      Explicit constructor for the Session class.
+//
+isp::Session::Session(const char * device,
+                      bool isActiveLowReset,
+                      bool isVerbose,
+                      unsigned maxBaud)
+        : mDevice(device),
+          mSerial(device),
+          mISP(mSerial, isActiveLowReset, isVerbose),
+          mpPart(&isp::Part::getDefault()),
+          mMaxBaud(maxBaud),
+          mIsReset(false),
+          mIsOpen(false)
+{}
+
+
+//
+//  @brief      Reset the target into ISP mode and synchronize.
+//
+isp::ISP::Error isp::Session::open(unsigned syncRetries, bool isReset)
+{
+    isp::ISP::Error error = isp::ISP::ERR_ISP_TIMEOUT;
+
+    LOG(INFO) << "Entering " << __func__ << "(" << mDevice << ")";
+
+    do
+    {
+        if (!mSerial.isOpen())
+        {
+            LOG(ERROR) << "Cannot open serial device " << mDevice << ": "
+                       << mSerial.getError();
+            break;
+        }
+
+        if (gIsRtsCts && !mSerial.setFlowControl(isp::Serial::FLOW_RTSCTS))
+            LOG(WARNING) << mDevice << ": RTS/CTS flow control not supported";
+
+        if (gIsLowLatency && !mSerial.setLowLatency(true))
+            LOG(WARNING) << mDevice << ": low-latency mode not supported";
+        LOG(INFO) << mDevice << ": " << mSerial.getLatency();
+        mISP.setPipeline(gIsPipeline);
+
+        // Skip the reset when an earlier session left the target in ISP
+        if (isReset)
+        {
+            isp::Metrics::Timer timer(mISP.getMetrics(), isp::Metrics::PHASE_SYNC);
+
+            if ((error = mISP.detect()) == isp::ISP::ERR_ISP_NO_ERROR)
+            {
+                mISP.getMetrics().count(isp::Metrics::COUNTER_RESET_SKIPPED);
+                mIsReset = true;
+            }
+        }
+
+        for (unsigned retries = syncRetries;
+             retries > 0 && error != isp::ISP::ERR_ISP_NO_ERROR; --retries)
+        {
+            // Enter ISP programming mode.
+            if (isReset)
+            {
+                isp::Metrics::Timer timer(mISP.getMetrics(), isp::Metrics::PHASE_RESET);
+
+                mISP.programMode();
+                mIsReset = true;
+            }
+
+            if (gQuit == true)
+                break;
+
+            // Synchronize to the target
+            isp::Metrics::Timer timer(mISP.getMetrics(), isp::Metrics::PHASE_SYNC);
+            if ((error = mISP.synchronize()))
+            {
+                LOG(WARNING) << "Initial synchronization failed: " << error;
+                if (retries)
+                {
+                    LOG(INFO) << "Retrying synchronization...";
+                    continue;
+                }
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (error != isp::ISP::ERR_ISP_NO_ERROR)
+        {
+            LOG(ERROR) << "Synchronization failed -- ABORTING";
+            break;
+        }
+
+        // Setup the fastest baud rate the link carries
+        {
+            isp::Metrics::Timer timer(mISP.getMetrics(), isp::Metrics::PHASE_BAUD);
+            error = mISP.negotiateBaudRate(mMaxBaud);
+        }
+
+        if (error)
+        {
+            LOG(ERROR) << "Error in setting baud rate: " << error;
+            break;
+        }
+
+        // Target chip ID
+        uint32_t chip = 0U;
+        if ((error = mISP.queryId(chip)))
+        {
+            LOG(ERROR) << "Error in querying chip ID: " << error;
+            break;
+        }
+
+        mpPart = isp::Part::find(chip);
+        if (!mpPart)
+        {
+            mpPart = &isp::Part::getDefault();
+            LOG(WARNING) << "Unknown part 0x" << std::hex << chip
+                         << "; assuming " << mpPart->name;
+        }
+
+        LOG(INFO) << mDevice << ": part is " << mpPart->name << ": "
+                  << std::dec << (mpPart->flashSize / 1024) << " KB flash in "
+                  << mpPart->sectorCount << " sectors, "
+                  << (mpPart->ramSize / 1024) << " KB RAM";
+        mIsOpen = true;
+    } while (false);
+
+    LOG(INFO) << "Leaving " << __func__ << "(" << mDevice << "): errorCode is "
+              << error;
+    return error;
+}
+
+
+//
+//  @brief      Run a pipeline of steps on the open connection.
+//
+isp::ISP::Error isp::Session::run(unsigned steps)
+{
+    isp::ISP::Error error = isp::ISP::ERR_ISP_NO_ERROR;
+
+    do
+    {
+        // Nothing but the reset makes sense without a connection
+        if (!mIsOpen)
+        {
+            error = isp::ISP::ERR_ISP_TIMEOUT;
+            break;
+        }
+
+        if ((steps & STEP_ERASE) && (error = isp::eraseClient(mISP, *mpPart)))
+            break;
+
+        if ((steps & STEP_PROGRAM) && (error = isp::programClient(mISP, *mpPart)))
+            break;
+
+        if ((steps & STEP_VERIFY) && (error = isp::examineClient(mISP, *mpPart)))
+            break;
+
+    } while (false);
+
+    // Leave ISP mode even when a step failed so the target is not left
+    // sitting in the bootloader.
+    if ((steps & STEP_RUN) && mIsReset)
+    {
+        mISP.applicationMode();
+        mIsReset = false;
+        mIsOpen = false;
+    }
+    return error;
+}
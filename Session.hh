@@ -0,0 +1,163 @@
+///
+/// @file   Session.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef SESSION_HH_
+#define SESSION_HH_
+
+//  Includes
+#include <stdint.h>
+#include <string>
+#include "ISP.hh"
+#include "Part.hh"
+#include "Serial.hh"
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      ISP session class.
+///
+/// @details    This class holds one open connection to the target.  The
+///             target is reset into ISP mode and synchronized once, and
+///             the requested erase, program, verify and run steps all
+///             share that connection.
+///
+class Session
+{
+public:
+    typedef enum {
+        STEP_ERASE      = 1,
+        STEP_PROGRAM    = 2,
+        STEP_VERIFY     = 4,
+        STEP_RUN        = 8
+    } Step;
+
+    ///
+    /// @brief      Explicit constructor for the Session class.
+    ///
+    /// @param[in]  device
+    ///             The string for the serial device to open.
+    ///
+    /// @param[in]  isActiveLowReset
+    ///             The boolean flag for reset polarity.
+    ///
+    /// @param[in]  isVerbose
+    ///             The boolean flag for the debug verbosity.
+    ///
+    /// @param[in]  maxBaud
+    ///             The highest baud rate to negotiate with the target.
+    ///
+    Session(const char * device,
+            bool isActiveLowReset = true,
+            bool isVerbose = false,
+            unsigned maxBaud = 115200);
+
+    ///
+    /// @brief      Default destructor for the Session class.
+    ///
+    ~Session() {}
+
+    ///
+    /// @brief      Reset the target into ISP mode and synchronize.
+    ///
+    /// @details    Negotiates the baud rate and identifies the part once the
+    ///             target answers.  In gang mode the reset lines are shared
+    ///             by every board, so the caller resets the fixture once
+    ///             and each session only synchronizes.
+    ///
+    /// @param[in]  syncRetries
+    ///             The number of retries to establish synchronization.
+    ///
+    /// @param[in]  isReset
+    ///             The boolean flag to reset the target into ISP mode before
+    ///             each synchronization attempt.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
+    ///
+    ISP::Error open(unsigned syncRetries, bool isReset = true);
+
+    ///
+    /// @brief      Run a pipeline of steps on the open connection.
+    ///
+    /// @details    The steps run in the order erase, program, verify and
+    ///             run, and the pipeline stops at the first failure.  The
+    ///             run step resets the target into the application.
+    ///
+    /// @param[in]  steps
+    ///             The bit mask of Step values to run.
+    ///
+    /// @return     The error code for the operation where zero is success and
+    ///             any other value is an error.
+    ///
+    ISP::Error run(unsigned steps);
+
+    ///
+    /// @brief      Get the ISP interface of the session.
+    ///
+    /// @return     Reference to the ISP instance.
+    ///
+    isp::ISP& getISP() { return mISP; }
+
+    ///
+    /// @brief      Get the geometry of the target part.
+    ///
+    /// @return     Reference to the part entry; the default part until the
+    ///             session is open.
+    ///
+    const PartInfo& getPart() { return *mpPart; }
+
+    ///
+    /// @brief      Get the serial device name of the session.
+    ///
+    /// @return     Reference to the device name string.
+    ///
+    const std::string& getDevice() const { return mDevice; }
+
+private:
+    ///
+    /// @brief      Default constructor.
+    ///
+    /// @details    Force the use of the explicit constructor by not
+    ///             allowing the default constructor to exist.
+    ///
+    Session() = delete;
+
+    ///
+    /// @brief      Session copy constructor (non-copyable)
+    ///
+    /// @details    Make the class non-copyable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a Session instance to copy from.
+    ///
+    Session(const Session& ref) = delete;
+
+    ///
+    /// @brief      Session assignment operator (not-assignable)
+    ///
+    /// @details    Make the class non-assignable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a Session instance to copy from.
+    ///
+    /// @return     New instance for the left-hand side of the expression.
+    ///
+    Session& operator = (const Session& ref) = delete;
+
+    // Data members
+    std::string         mDevice;
+    isp::Serial         mSerial;
+    isp::ISP            mISP;
+    const PartInfo *    mpPart;
+    unsigned            mMaxBaud;
+    bool                mIsReset;
+    bool                mIsOpen;
+};  // class
+
+} // namespace
+#endif
@@ -0,0 +1,666 @@
+///
+/// @file   Target.cc
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+
+//  Includes
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sstream>
+#include "ISP.hh"
+#include "Log.hh"
+#include "Target.hh"
+
+
+//  Definitions
+#define UNLOCK_CODE     (23130U)
+#define PAGE_SIZE       (256U)
+#define BOOT_VERSION    "1\r\n13\r\n"       // minor, major
+#define IDLE_RESET_MS   (500U)              // drop a partial line when idle
+
+//  Only these rates are accepted by the 'B' command
+static const unsigned sBaudRates[] =
+{
+    9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600
+};
+
+
+//
+//  @brief      Get the nanoseconds from one monotonic time stamp to another.
+//
+static int64_t diffNS(const struct timespec& from, const struct timespec& to)
+{
+    return (static_cast<int64_t>(to.tv_sec - from.tv_sec) * 1000000000LL) +
+           (to.tv_nsec - from.tv_nsec);
+}
+
+
+//
+//  @brief      Parse a decimal command parameter.
+//
+static bool toUnsigned(const std::string& str, uint32_t& value)
+{
+    char * pEnd = nullptr;
+    unsigned long result = strtoul(str.c_str(), &pEnd, 10);
+
+    if (str.empty() || *pEnd != '\0' || result > UINT32_MAX)
+        return false;
+
+    value = static_cast<uint32_t>(result);
+    return true;
+}
+
+
+//
+//  @brief      Explicit constructor for the Target class.
+//
+isp::Target::Target(int fd, const isp::PartInfo& part)
+        : mFileDes(fd),
+          mPart(part),
+          mState(STATE_AUTOBAUD),
+          mBoot(BOOT_NONE),
+          mFlash(part.flashSize, 0xff),
+          mRAM(part.ramSize, 0x00),
+          mPrepared(part.sectorCount, false),
+          mDataAddress(0U),
+          mDataRemaining(0U),
+          mIsEcho(true),
+          mIsHeld(false),
+          mIsUnlocked(false),
+          mIsVerbose(false),
+          mBaudRate(115200),
+          mByteTimeInNS(-1),
+          mEraseTimeInMS(DEFAULT_ERASE_TIME),
+          mProgramTimeInUS(DEFAULT_PROGRAM_TIME)
+{
+    clock_gettime(CLOCK_MONOTONIC, &mLineFree);
+    mLastInput = mLineFree;
+}
+
+
+//
+//  @brief      Set a fixed time per byte on the wire.
+//
+void isp::Target::setByteTime(unsigned byteTimeInUS)
+{
+    mByteTimeInNS = static_cast<int64_t>(byteTimeInUS) * 1000;
+}
+
+
+//
+//  @brief      Get the time one byte spends on the wire.
+//
+int64_t isp::Target::getByteTime()
+{
+    // Ten bit times per byte: start, eight data bits and stop
+    return (mByteTimeInNS >= 0)? mByteTimeInNS: (10LL * 1000000000LL / mBaudRate);
+}
+
+
+//
+//  @brief      Reset the emulated part into autobaud detection.
+//
+void isp::Target::reset()
+{
+    mState = STATE_AUTOBAUD;
+    mLine.clear();
+    mPrepared.assign(mPrepared.size(), false);
+    mDataRemaining = 0U;
+    mIsEcho = true;
+    mIsUnlocked = false;
+    mBaudRate = 115200;
+}
+
+
+//
+//  @brief      Wait for input and answer it.
+//
+bool isp::Target::poll(unsigned timeoutInMS)
+{
+    struct pollfd   pfd = { mFileDes, POLLIN, 0 };
+    int             result = ::poll(&pfd, 1, static_cast<int>(timeoutInMS));
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (result < 0)
+        return (errno == EINTR);
+
+    if (result == 0 || !(pfd.revents & POLLIN))
+    {
+        // A client that went away mid-command leaves a partial line or a
+        // short write behind; forget it so the next '?' starts a line.
+        if (diffNS(mLastInput, now) > IDLE_RESET_MS * 1000000LL)
+        {
+            mLine.clear();
+            if (mState == STATE_DATA)
+                mState = STATE_COMMAND;
+        }
+        return !(pfd.revents & (POLLERR | POLLNVAL));
+    }
+
+    // Take no more than a millisecond of wire time at once so the client
+    // sees the input drain at the emulated baud rate
+    uint8_t buffer[ 4096 ];
+    int64_t byteTime = getByteTime();
+    size_t  size = sizeof(buffer);
+
+    if (byteTime > 0)
+        size = std::max<size_t>(1U, std::min<size_t>(size, 1000000LL / byteTime));
+
+    ssize_t count = ::read(mFileDes, buffer, size);
+
+    if (count <= 0)
+        return (count < 0 && (errno == EINTR || errno == EAGAIN));
+
+    // The bytes took this long to arrive at the emulated baud rate
+    mLastInput = now;
+    pace(count);
+
+    for (ssize_t ii = 0; ii < count; ++ii)
+        receive(buffer[ ii ]);
+
+    return true;
+}
+
+
+//
+//  @brief      Serve the file descriptor until asked to stop.
+//
+void isp::Target::run(const std::atomic<bool>& isDone)
+{
+    while (!isDone && poll(50U))
+        ;
+}
+
+
+//
+//  @brief      Calculate the CRC-32 the bootloader returns for 'S'.
+//
+uint32_t isp::Target::crc32(const uint8_t * pBlock, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    // IEEE 802.3, reflected: polynomial 0x04C11DB7 taken LSB first
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        crc ^= pBlock[ ii ];
+        for (unsigned bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ ((crc & 1U)? 0xEDB88320U: 0U);
+    }
+    return ~crc;
+}
+
+
+//
+//  @brief      Feed one received byte to the parser.
+//
+void isp::Target::receive(uint8_t byte)
+{
+    switch (mBoot.exchange(BOOT_NONE))
+    {
+        case BOOT_APPLICATION:
+            reset();
+            mState = STATE_APPLICATION;
+            mIsHeld = true;
+            break;
+
+        case BOOT_ISP:
+            reset();
+            mIsHeld = false;
+            break;
+
+        default:
+            break;
+    }
+
+    switch (mState)
+    {
+        case STATE_AUTOBAUD:
+            if (byte == '?')
+            {
+                send("Synchronized\r\n");
+                mState = STATE_SYNC;
+                mLine.clear();
+            }
+            break;
+
+        case STATE_SYNC:
+            if (byte == '?' && mLine.empty())
+            {
+                send("Synchronized\r\n");
+            }
+            else if (byte == '\n')
+            {
+                if (mLine == "Synchronized" || mLine == "Synchronized\r")
+                {
+                    send("Synchronized\r\nOK\r\n");
+                    mState = STATE_COMMAND;
+                }
+                else
+                {
+                    mState = STATE_AUTOBAUD;
+                }
+                mLine.clear();
+            }
+            else
+            {
+                mLine += static_cast<char>(byte);
+            }
+            break;
+
+        case STATE_APPLICATION:
+        case STATE_COMMAND:
+            // A '?' opening a line stands in for the RESET line, unless
+            // the part was booted through it
+            if (byte == '?' && mLine.empty() && !mIsHeld)
+            {
+                reset();
+                receive(byte);
+                break;
+            }
+
+            if (mState == STATE_APPLICATION)
+                break;
+
+            if (mIsEcho)
+                send(&byte, 1);
+
+            // ESC (and the apostrophe the client sends after
+            // synchronizing) discards the line so far
+            if (byte == 0x1b || byte == 0x27)
+            {
+                mLine.clear();
+            }
+            else if (byte == '\n')
+            {
+                std::string line = mLine;
+
+                mLine.clear();
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (!line.empty())
+                    execute(line);
+            }
+            else
+            {
+                mLine += static_cast<char>(byte);
+            }
+            break;
+
+        case STATE_DATA:
+            mRAM[ mDataAddress - isp::Part::RAM_BASE ] = byte;
+            ++mDataAddress;
+            if (mIsEcho)
+                send(&byte, 1);
+            if (--mDataRemaining == 0U)
+                mState = STATE_COMMAND;
+            break;
+    }
+}
+
+
+//
+//  @brief      Execute one command line.
+//
+void isp::Target::execute(const std::string& line)
+{
+    std::vector<std::string>    fields;
+    std::vector<uint32_t>       args;
+    std::ostringstream          data;
+    isp::ISP::Error             error = isp::ISP::ERR_ISP_NO_ERROR;
+    std::istringstream          input(line);
+    std::string                 field;
+    uint64_t                    busyInUS = 0U;
+
+    while (input >> field)
+        fields.push_back(field);
+
+    std::string command = fields.empty()? "": fields[ 0 ];
+    for (size_t ii = 1; ii < fields.size(); ++ii)
+    {
+        uint32_t value = 0U;
+
+        // 'G' takes the letter T as its mode
+        if (command == "G" && ii == 2)
+            value = (fields[ ii ] == "T")? 1U: 0U;
+        else if (!toUnsigned(fields[ ii ], value))
+            error = isp::ISP::ERR_ISP_PARAM_ERROR;
+        args.push_back(value);
+    }
+
+    if (mIsVerbose)
+        LOG(INFO) << "Command: " << line;
+
+    do
+    {
+        if (error)
+            break;
+
+        if (command.size() != 1)
+        {
+            error = isp::ISP::ERR_ISP_INVALID_COMMAND;
+            break;
+        }
+
+        static const char * sCommands = "ABCEGIJKNPRSUW";
+        static const size_t sArgCounts[] = { 1, 2, 3, 2, 2, 2, 0, 0, 0, 2, 2, 2, 1, 2 };
+        const char * pCommand = strchr(sCommands, command[ 0 ]);
+
+        if (!pCommand)
+        {
+            error = isp::ISP::ERR_ISP_INVALID_COMMAND;
+            break;
+        }
+
+        if (args.size() != sArgCounts[ pCommand - sCommands ])
+        {
+            error = isp::ISP::ERR_ISP_PARAM_ERROR;
+            break;
+        }
+
+        switch (command[ 0 ])
+        {
+            case 'U':
+                if (args[ 0 ] == UNLOCK_CODE)
+                    mIsUnlocked = true;
+                else
+                    error = isp::ISP::ERR_ISP_INVALID_CODE;
+                break;
+
+            case 'A':
+                if (args[ 0 ] > 1U)
+                    error = isp::ISP::ERR_ISP_PARAM_ERROR;
+                else
+                    mIsEcho = (args[ 0 ] == 1U);
+                break;
+
+            case 'B':
+                if (std::find(std::begin(sBaudRates), std::end(sBaudRates), args[ 0 ]) ==
+                    std::end(sBaudRates))
+                    error = isp::ISP::ERR_ISP_INVALID_BAUD_RATE;
+                else if (args[ 1 ] != 1U && args[ 1 ] != 2U)
+                    error = isp::ISP::ERR_ISP_INVALID_STOP_BIT;
+                break;
+
+            case 'J':
+                data << mPart.id << "\r\n";
+                break;
+
+            case 'K':
+                data << BOOT_VERSION;
+                break;
+
+            case 'N':
+                data << 0x4d2e1549U << "\r\n" << 0x0a000001U << "\r\n"
+                     << (0x20260000U | mPart.id) << "\r\n" << 0x1234abcdU << "\r\n";
+                break;
+
+            case 'P':
+            case 'E':
+            case 'I':
+            {
+                uint32_t start = args[ 0 ];
+                uint32_t end = args[ 1 ];
+
+                if (command[ 0 ] == 'E' && !mIsUnlocked)
+                {
+                    error = isp::ISP::ERR_ISP_CMD_LOCKED;
+                    break;
+                }
+
+                if (end < start || end >= mPart.sectorCount)
+                {
+                    error = isp::ISP::ERR_ISP_INVALID_SECTOR;
+                    break;
+                }
+
+                for (uint32_t sector = start; sector <= end; ++sector)
+                {
+                    if (command[ 0 ] == 'P')
+                    {
+                        mPrepared[ sector ] = true;
+                    }
+                    else if (command[ 0 ] == 'E' && !mPrepared[ sector ])
+                    {
+                        error = isp::ISP::ERR_ISP_SECTOR_NOT_PREPARED_FOR_WRITE_OPERATION;
+                        break;
+                    }
+                }
+
+                if (command[ 0 ] == 'E' && !error)
+                {
+                    std::fill(mFlash.begin() + start * isp::Part::SECTOR_SIZE,
+                              mFlash.begin() + (end + 1) * isp::Part::SECTOR_SIZE,
+                              0xff);
+                    std::fill(mPrepared.begin() + start, mPrepared.begin() + end + 1, false);
+                    busyInUS = static_cast<uint64_t>(end - start + 1) * mEraseTimeInMS * 1000U;
+                }
+                else if (command[ 0 ] == 'I')
+                {
+                    for (uint32_t offset = start * isp::Part::SECTOR_SIZE;
+                         offset < (end + 1) * isp::Part::SECTOR_SIZE;
+                         offset += 4)
+                    {
+                        uint32_t word = mFlash[ offset ] |
+                                        (mFlash[ offset + 1 ] << 8) |
+                                        (mFlash[ offset + 2 ] << 16) |
+                                        (static_cast<uint32_t>(mFlash[ offset + 3 ]) << 24);
+
+                        if (word != 0xffffffffU)
+                        {
+                            error = isp::ISP::ERR_ISP_SECTOR_NOT_BLANK;
+                            data << offset << "\r\n" << word << "\r\n";
+                            break;
+                        }
+                    }
+                }
+                break;
+            }
+
+            case 'W':
+            case 'R':
+            case 'S':
+            {
+                uint32_t address = args[ 0 ];
+                uint32_t count = args[ 1 ];
+                uint8_t * pMemory = nullptr;
+
+                if (address % 4U)
+                    error = isp::ISP::ERR_ISP_ADDR_ERROR;
+                else if (count % 4U)
+                    error = isp::ISP::ERR_ISP_COUNT_ERROR;
+                else if (command[ 0 ] == 'W')
+                {
+                    if (!map(address, count, false))
+                        error = isp::ISP::ERR_ISP_ADDR_NOT_MAPPED;
+                }
+                else if (!(pMemory = map(address, count, true)) &&
+                         !(pMemory = map(address, count, false)))
+                    error = isp::ISP::ERR_ISP_ADDR_NOT_MAPPED;
+
+                if (error || count == 0U)
+                    break;
+
+                if (command[ 0 ] == 'W')
+                {
+                    mState = STATE_DATA;
+                    mDataAddress = address;
+                    mDataRemaining = count;
+                }
+                else if (command[ 0 ] == 'R')
+                {
+                    data.write(reinterpret_cast<const char *>(pMemory), count);
+                }
+                else
+                {
+                    data << crc32(pMemory, count) << "\r\n";
+                }
+                break;
+            }
+
+            case 'C':
+            {
+                uint32_t flash = args[ 0 ];
+                uint32_t ram = args[ 1 ];
+                uint32_t count = args[ 2 ];
+                uint8_t * pFlash = nullptr;
+                uint8_t * pRAM = nullptr;
+
+                if (!mIsUnlocked)
+                    error = isp::ISP::ERR_ISP_CMD_LOCKED;
+                else if (flash % PAGE_SIZE)
+                    error = isp::ISP::ERR_ISP_DST_ADDR_ERROR;
+                else if (ram % 4U)
+                    error = isp::ISP::ERR_ISP_SRC_ADDR_ERROR;
+                else if (count != 256U && count != 512U && count != 1024U && count != 4096U)
+                    error = isp::ISP::ERR_ISP_COUNT_ERROR;
+                else if (!(pFlash = map(flash, count, true)))
+                    error = isp::ISP::ERR_ISP_DST_ADDR_NOT_MAPPED;
+                else if (!(pRAM = map(ram, count, false)))
+                    error = isp::ISP::ERR_ISP_SRC_ADDR_NOT_MAPPED;
+
+                if (error)
+                    break;
+
+                uint32_t first = flash / isp::Part::SECTOR_SIZE;
+                uint32_t last = (flash + count - 1) / isp::Part::SECTOR_SIZE;
+
+                for (uint32_t sector = first; sector <= last; ++sector)
+                {
+                    if (!mPrepared[ sector ])
+                        error = isp::ISP::ERR_ISP_SECTOR_NOT_PREPARED_FOR_WRITE_OPERATION;
+                }
+
+                if (error)
+                    break;
+
+                // Programming can only clear bits
+                for (uint32_t ii = 0; ii < count; ++ii)
+                    pFlash[ ii ] &= pRAM[ ii ];
+
+                std::fill(mPrepared.begin() + first, mPrepared.begin() + last + 1, false);
+                busyInUS = static_cast<uint64_t>(count / PAGE_SIZE) * mProgramTimeInUS;
+                break;
+            }
+
+            case 'G':
+                if (!mIsUnlocked)
+                    error = isp::ISP::ERR_ISP_CMD_LOCKED;
+                else if (args[ 1 ] != 1U)
+                    error = isp::ISP::ERR_ISP_PARAM_ERROR;
+                else if (!map(args[ 0 ] & ~1U, 4, true))
+                    error = isp::ISP::ERR_ISP_ADDR_NOT_MAPPED;
+                break;
+        }
+    } while (false);
+
+    if (mIsVerbose && error)
+        LOG(WARNING) << "Command '" << line << "' failed: " << error;
+
+    // The flash controller holds off the reply while it works
+    if (busyInUS)
+        pace(0, busyInUS);
+
+    std::ostringstream reply;
+    reply << static_cast<int>(error) << "\r\n";
+
+    if (!error || error == isp::ISP::ERR_ISP_SECTOR_NOT_BLANK)
+        reply << data.str();
+    send(reply.str());
+
+    if (!error && command == "B")
+        mBaudRate = args[ 0 ];
+    else if (!error && command == "G")
+        mState = STATE_APPLICATION;
+}
+
+
+//
+//  @brief      Map a target address range onto the memory model.
+//
+uint8_t * isp::Target::map(uint32_t address, size_t size, bool isFlash)
+{
+    if (isFlash)
+    {
+        if (address < mPart.flashSize && size <= mPart.flashSize - address)
+            return &mFlash[ address ];
+    }
+    else if (address >= mPart.ramStart && address < mPart.ramEnd &&
+             size <= mPart.ramEnd - address)
+    {
+        return &mRAM[ address - isp::Part::RAM_BASE ];
+    }
+    return nullptr;
+}
+
+
+//
+//  @brief      Send bytes to the client at the simulated baud rate.
+//
+void isp::Target::send(const void * pBuffer, size_t size)
+{
+    const uint8_t * p = static_cast<const uint8_t *>(pBuffer);
+    int64_t byteTime = getByteTime();
+    size_t  chunk = size;
+
+    // Release no more than a millisecond of wire time at once so a long
+    // reply streams in the way it would from a UART
+    if (byteTime > 0)
+        chunk = std::max<size_t>(1U, std::min<size_t>(size, 1000000LL / byteTime));
+
+    while (size > 0)
+    {
+        size_t remaining = std::min(chunk, size);
+
+        pace(remaining);
+        while (remaining > 0)
+        {
+            ssize_t count = ::write(mFileDes, p, remaining);
+
+            if (count < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN)
+                    continue;
+                LOG(ERROR) << "Write failed: " << strerror(errno);
+                return;
+            }
+            p += count;
+            size -= count;
+            remaining -= count;
+        }
+    }
+}
+
+
+//
+//  @brief      Hold the line busy for a number of bytes or microseconds.
+//
+void isp::Target::pace(size_t bytes, uint64_t extraInUS)
+{
+    int64_t byteTime = getByteTime();
+    int64_t delay = static_cast<int64_t>(bytes) * byteTime +
+                    static_cast<int64_t>(extraInUS) * 1000;
+    struct timespec now;
+
+    if (delay <= 0)
+        return;
+
+    // Keep an absolute schedule so short sleeps do not drift
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (diffNS(mLineFree, now) > 0)
+        mLineFree = now;
+
+    int64_t ns = mLineFree.tv_nsec + delay;
+    mLineFree.tv_sec += ns / 1000000000LL;
+    mLineFree.tv_nsec = ns % 1000000000LL;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &mLineFree, nullptr) == EINTR)
+        ;
+}
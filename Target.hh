@@ -0,0 +1,313 @@
+///
+/// @file   Target.hh
+///
+/// @date   16 Oct 2026
+/// @author Don McNeill dmcneill@me.com
+///
+#ifndef TARGET_HH_
+#define TARGET_HH_
+
+//  Includes
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "Part.hh"
+
+
+//  Namespace
+namespace isp {
+
+///
+/// @brief      LPC15xx ISP bootloader emulator.
+///
+/// @details    This class answers the serial ISP commands used by the client
+///             on a file descriptor, normally the master side of a
+///             pseudo-terminal.  Flash and RAM are kept in memory, and the
+///             time the real part spends on the wire and in the flash
+///             controller is simulated so that whole jobs can be timed.
+///
+///             There is no RESET line on a pseudo-terminal, so a '?' at the
+///             start of a command line resets the emulated part back into
+///             autobaud detection.
+///
+class Target
+{
+public:
+    static const unsigned DEFAULT_ERASE_TIME    = 100;      ///< ms per sector
+    static const unsigned DEFAULT_PROGRAM_TIME  = 1000;     ///< us per 256 bytes
+
+    ///
+    /// @brief      Explicit constructor for the Target class.
+    ///
+    /// @param[in]  fd
+    ///             The file descriptor to serve; it is not closed.
+    ///
+    /// @param[in]  part
+    ///             Reference to the part to emulate.
+    ///
+    Target(int fd, const PartInfo& part);
+
+    ///
+    /// @brief      Default destructor for the Target class.
+    ///
+    ~Target() {}
+
+    ///
+    /// @brief      Set a fixed time per byte on the wire.
+    ///
+    /// @details    By default each byte takes ten bit times at the baud
+    ///             rate selected with the 'B' command.
+    ///
+    /// @param[in]  byteTimeInUS
+    ///             The time per byte in microseconds; zero disables the
+    ///             delay.
+    ///
+    void setByteTime(unsigned byteTimeInUS);
+
+    ///
+    /// @brief      Set the time taken to erase one sector.
+    ///
+    /// @param[in]  eraseTimeInMS
+    ///             The erase time in milliseconds.
+    ///
+    void setEraseTime(unsigned eraseTimeInMS) { mEraseTimeInMS = eraseTimeInMS; }
+
+    ///
+    /// @brief      Set the time taken to program one 256-byte page.
+    ///
+    /// @param[in]  programTimeInUS
+    ///             The program time in microseconds.
+    ///
+    void setProgramTime(unsigned programTimeInUS) { mProgramTimeInUS = programTimeInUS; }
+
+    ///
+    /// @brief      Set the verbosity of the command trace.
+    ///
+    /// @param[in]  isVerbose
+    ///             The boolean flag for the debug verbosity.
+    ///
+    void setVerbose(bool isVerbose) { mIsVerbose = isVerbose; }
+
+    ///
+    /// @brief      Reset the emulated part into autobaud detection.
+    ///
+    /// @details    Flash contents are kept.
+    ///
+    void reset();
+
+    ///
+    /// @brief      Boot the application as the RESET line would with the
+    ///             ISP lines high.
+    ///
+    /// @details    Until enterBootloader is called a '?' no longer stands
+    ///             in for the RESET line, so the client has to reset the
+    ///             part to reach the bootloader.  Safe to call from another
+    ///             thread; it takes effect at the next byte received.
+    ///
+    void startApplication() { mBoot = BOOT_APPLICATION; }
+
+    ///
+    /// @brief      Reset into the bootloader as the RESET line would with
+    ///             the ISP lines low.
+    ///
+    /// @details    Safe to call from another thread; it takes effect at the
+    ///             next byte received.
+    ///
+    void enterBootloader() { mBoot = BOOT_ISP; }
+
+    ///
+    /// @brief      Wait for input and answer it.
+    ///
+    /// @param[in]  timeoutInMS
+    ///             The time to wait for input in milliseconds.
+    ///
+    /// @return     Boolean false if the file descriptor failed.
+    ///
+    bool poll(unsigned timeoutInMS);
+
+    ///
+    /// @brief      Serve the file descriptor until asked to stop.
+    ///
+    /// @param[in]  isDone
+    ///             Reference to the flag that stops the loop.
+    ///
+    void run(const std::atomic<bool>& isDone);
+
+    ///
+    /// @brief      Get the emulated flash contents.
+    ///
+    /// @return     Reference to the flash array.
+    ///
+    std::vector<uint8_t>& getFlash() { return mFlash; }
+
+    ///
+    /// @brief      Get the baud rate selected by the client.
+    ///
+    /// @return     The current baud rate.
+    ///
+    unsigned getBaudRate() { return mBaudRate; }
+
+    ///
+    /// @brief      Calculate the CRC-32 the bootloader returns for 'S'.
+    ///
+    /// @details    Bit by bit, apart from the table-driven Utility::crc32
+    ///             used by the client, so that each checks the other.
+    ///
+    /// @param[in]  pBlock
+    ///             The bytes.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    /// @return     The CRC-32 of the bytes.
+    ///
+    static uint32_t crc32(const uint8_t * pBlock, size_t size);
+
+private:
+    ///
+    /// @brief      Parser states.
+    ///
+    typedef enum {
+        STATE_AUTOBAUD,         ///< Waiting for '?'
+        STATE_SYNC,             ///< Waiting for "Synchronized"
+        STATE_COMMAND,          ///< Collecting a command line
+        STATE_DATA,             ///< Receiving the data of a 'W' command
+        STATE_APPLICATION       ///< Running the application after 'G'
+    } State;
+
+    ///
+    /// @brief      Boot requests made through the reset line.
+    ///
+    typedef enum {
+        BOOT_NONE,              ///< Nothing pending
+        BOOT_APPLICATION,       ///< Run the application, ignoring '?'
+        BOOT_ISP                ///< Enter autobaud detection
+    } Boot;
+
+    ///
+    /// @brief      Default constructor.
+    ///
+    /// @details    Force the use of the explicit constructor by not
+    ///             allowing the default constructor to exist.
+    ///
+    Target() = delete;
+
+    ///
+    /// @brief      Target copy constructor (non-copyable)
+    ///
+    /// @details    Make the class non-copyable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a Target instance to copy from.
+    ///
+    Target(const Target& ref) = delete;
+
+    ///
+    /// @brief      Target assignment operator (not-assignable)
+    ///
+    /// @details    Make the class non-assignable.
+    ///
+    /// @param[in]  ref
+    ///             Reference to a Target instance to copy from.
+    ///
+    /// @return     New instance for the left-hand side of the expression.
+    ///
+    Target& operator = (const Target& ref) = delete;
+
+    ///
+    /// @brief      Feed one received byte to the parser.
+    ///
+    /// @param[in]  byte
+    ///             The received byte.
+    ///
+    void receive(uint8_t byte);
+
+    ///
+    /// @brief      Execute one command line.
+    ///
+    /// @param[in]  line
+    ///             The command line without its line ending.
+    ///
+    void execute(const std::string& line);
+
+    ///
+    /// @brief      Map a target address range onto the memory model.
+    ///
+    /// @param[in]  address
+    ///             The target address.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes.
+    ///
+    /// @param[in]  isFlash
+    ///             Map flash when true and the ISP RAM window when false.
+    ///
+    /// @return     Pointer into the model, or nullptr if the range is not
+    ///             mapped.
+    ///
+    uint8_t * map(uint32_t address, size_t size, bool isFlash);
+
+    ///
+    /// @brief      Send bytes to the client at the simulated baud rate.
+    ///
+    /// @param[in]  pBuffer
+    ///             Pointer to the bytes to send.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes to send.
+    ///
+    void send(const void * pBuffer, size_t size);
+
+    ///
+    /// @brief      Send a string to the client.
+    ///
+    /// @param[in]  str
+    ///             The string to send.
+    ///
+    void send(const std::string& str) { send(str.data(), str.size()); }
+
+    ///
+    /// @brief      Get the time one byte spends on the wire.
+    ///
+    /// @return     The byte time in nanoseconds.
+    ///
+    int64_t getByteTime();
+
+    ///
+    /// @brief      Hold the line busy for a number of bytes or microseconds.
+    ///
+    /// @param[in]  bytes
+    ///             The number of byte times to wait.
+    ///
+    /// @param[in]  extraInUS
+    ///             Further time to wait in microseconds.
+    ///
+    void pace(size_t bytes, uint64_t extraInUS = 0U);
+
+    // Data members
+    int                     mFileDes;
+    const PartInfo&         mPart;
+    State                   mState;
+    std::atomic<int>        mBoot;
+    std::string             mLine;
+    std::vector<uint8_t>    mFlash;
+    std::vector<uint8_t>    mRAM;
+    std::vector<bool>       mPrepared;
+    uint32_t                mDataAddress;
+    size_t                  mDataRemaining;
+    bool                    mIsEcho;
+    bool                    mIsHeld;
+    bool                    mIsUnlocked;
+    bool                    mIsVerbose;
+    unsigned                mBaudRate;
+    int64_t                 mByteTimeInNS;
+    unsigned                mEraseTimeInMS;
+    unsigned                mProgramTimeInUS;
+    struct timespec         mLineFree;
+    struct timespec         mLastInput;
+};  // class
+
+} // namespace
+#endif
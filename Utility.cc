@@ -121,6 +121,58 @@ int isp::Utility::stringToInt(std::string& str)
 }
 
 
+//
+//  @brief      Get the unsigned 32-bit value of a string.
+//
+uint32_t isp::Utility::stringToUnsigned(std::string& str)
+{
+    uint32_t value = 0U;
+
+    try
+    {
+        value = static_cast<uint32_t>(stoul(str));
+    }
+    catch (...)
+    {
+        value = 0U;
+    }
+    return value;
+}
+
+
+//
+//  @brief      Fill in the byte-wise CRC-32 lookup table.
+//
+static bool crc32Table(uint32_t * pTable)
+{
+    for (uint32_t ii = 0; ii < 256; ++ii)
+    {
+        uint32_t value = ii;
+
+        for (unsigned bit = 0; bit < 8; ++bit)
+            value = (value & 1)? (0xEDB88320U ^ (value >> 1)): (value >> 1);
+        pTable[ ii ] = value;
+    }
+    return true;
+}
+
+
+//
+//  @brief      Calculate the CRC-32 of a block of memory.
+//
+uint32_t isp::Utility::crc32(const uint8_t * pBlock, size_t size)
+{
+    static uint32_t table[ 256 ];
+    static bool     isTableReady = crc32Table(table);
+    (void) isTableReady;
+
+    uint32_t crc = 0xFFFFFFFFU;
+    for (size_t ii = 0; ii < size; ++ii)
+        crc = table[ (crc ^ pBlock[ ii ]) & 0xFF ] ^ (crc >> 8);
+    return ~crc;
+}
+
+
 //
 //  @brief      Convert an ASCII hex string to a byte vector.
 //
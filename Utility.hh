@@ -58,6 +58,33 @@ public:
     ///
     static int stringToInt(std::string& str);
 
+    ///
+    /// @brief      Get the unsigned 32-bit value of a string.
+    ///
+    /// @param[in]  str
+    ///             The string holding the value to convert.
+    ///
+    /// @return     Unsigned value for the string; set to zero on error.
+    ///
+    static uint32_t stringToUnsigned(std::string& str);
+
+    ///
+    /// @brief      Calculate the CRC-32 of a block of memory.
+    ///
+    /// @details    Uses the same CRC as the bootloader's 'S' command: the
+    ///             reflected 0x04C11DB7 polynomial with the initial and
+    ///             final values set to 0xFFFFFFFF.
+    ///
+    /// @param[in]  pBlock
+    ///             A byte pointer to the block to checksum.
+    ///
+    /// @param[in]  size
+    ///             The number of bytes to checksum.
+    ///
+    /// @return     The CRC-32 value.
+    ///
+    static uint32_t crc32(const uint8_t * pBlock, size_t size);
+
     ///
     /// @brief      Convert an ASCII hex string to a byte vector.
     ///
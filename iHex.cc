@@ -6,23 +6,32 @@
 ///
 
 //  Includes
-#include <vector>
-#include <string>
-#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "HexDecoder.hh"
 #include "iHex.hh"
 #include "Log.hh"
-#include "Utility.hh"
+
+
+//  Definitions
+//  Characters in a record with no data: count, address, type and checksum
+#define RECORD_OVERHEAD (10U)
 
 
 //
 //  @brief      Explicit class constructor.
 //
-isp::iHex::iHex(const char * filename, uint8_t * pMemory, size_t size)
+isp::iHex::iHex(const char * filename, FirmwareImage& image)
       : mFilename(filename),
         mOffsetAddress(0U),
-        mStartAddress(size),
+        mStartAddress(UINT32_MAX),
         mEndAddress(0U),
-        mpMemory(pMemory)
+        mImage(image),
+        mIsEnd(false)
 {}
 
 
@@ -39,74 +48,153 @@ isp::iHex::~iHex()
 bool isp::iHex::parse()
 {
     bool        result = false;
+    int         fileDes = -1;
+    void *      pMap = MAP_FAILED;
+    struct stat info;
 
-    // Open the stream
-    if (mFilename.length())
+    do
     {
-        std::ifstream inFile(mFilename.c_str());
-        if (inFile.is_open())
+        if (!mFilename.length())
+            break;
+
+        if ((fileDes = open(mFilename.c_str(), O_RDONLY | O_CLOEXEC)) < 0 ||
+            fstat(fileDes, &info) < 0)
+        {
+            LOG(ERROR) << "Open failed for '" << mFilename << "' -- "
+                       << errno << " " << strerror(errno);
+            break;
+        }
+
+        if (info.st_size == 0)
+        {
+            LOG(ERROR) << "'" << mFilename << "' is empty";
+            break;
+        }
+
+        // Map the file and decode it in place, one pass front to back
+        pMap = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fileDes, 0);
+        if (pMap == MAP_FAILED)
         {
-            std::string line;
-            while (getline(inFile,line))
+            LOG(ERROR) << "Map failed for '" << mFilename << "' -- "
+                       << errno << " " << strerror(errno);
+            break;
+        }
+        madvise(pMap, info.st_size, MADV_SEQUENTIAL);
+
+        const uint8_t * p = static_cast<const uint8_t *>(pMap);
+        const uint8_t * pEnd = p + info.st_size;
+        unsigned line = 1;
+
+        result = true;
+        while ((p < pEnd) && !mIsEnd)
+        {
+            // Line endings and blank lines between records
+            if (*p == '\n')
+                ++line;
+            if ((*p == '\r') || (*p == '\n') || (*p == ' ') || (*p == '\t'))
             {
-                if (line[0] != ':')
-                    break;
+                ++p;
+                continue;
+            }
 
-                if (line.length() < 11)
-                    break;
+            const uint8_t * pEol = static_cast<const uint8_t *>(
+                                        memchr(p, '\n', pEnd - p));
+            const uint8_t * pStop = (pEol? pEol: pEnd);
 
-                // Remove the leading ':' and trailing '\n'
-                std::string trimmedLine = line.substr(1);
-                isp::Utility::cutLast(trimmedLine);
+            while ((pStop > p) && ((pStop[ -1 ] == '\r') || (pStop[ -1 ] == ' ')))
+                --pStop;
 
-                // Process the line
-                if (!process(trimmedLine))
-                    break;
+            if ((*p != ':') || !process(p + 1, pStop - p - 1))
+            {
+                LOG(ERROR) << "Bad record at line " << std::dec << line
+                           << " of '" << mFilename << "'";
+                result = false;
+                break;
             }
-            inFile.close();
-            result = true;
+            p = pStop;
         }
-    }
+
+        if (result && !mIsEnd)
+            LOG(WARNING) << "No end of file record in '" << mFilename << "'";
+
+    } while (false);
+
+    if (pMap != MAP_FAILED)
+        munmap(pMap, info.st_size);
+    if (fileDes >= 0)
+        close(fileDes);
+
     return result;
 }
 
 
 //
-//  @brief      Process the Intel Hex line.
+//  @brief      Process the Intel Hex record.
 //
-bool isp::iHex::process(std::string& line)
+bool isp::iHex::process(const uint8_t * pRecord, size_t length)
 {
     bool result = false;
-    std::vector<uint8_t> bytes;
-    std::vector<uint8_t> data;
+    uint8_t header[ 4 ];
+    uint8_t data[ 4 ];
+    uint8_t checksum = 0U;
+    unsigned sum = 0U;
 
     do
     {
-        Utility::stringToByte(const_cast<const std::string&>(line), bytes);
+        if ((length < RECORD_OVERHEAD) ||
+            !isp::HexDecoder::decodeScalar(pRecord, 4, header, sum))
+            break;
+
+        unsigned count   = header[ 0 ];
+        unsigned address = ((header[ 1 ] << 8) | header[ 2 ]);
+        int      type    = header[ 3 ];
+
+        if (length != RECORD_OVERHEAD + 2 * count)
+        {
+            LOG(ERROR) << "Record length " << std::dec << length
+                       << " does not match its count of " << count;
+            break;
+        }
+
+        const uint8_t * pData = pRecord + 8;
+
+        if (type == 0)
+        {
+            uint32_t base = mOffsetAddress + address;
+
+            if (count)
+            {
+                uint8_t * pOut = mImage.reserve(base, count);
 
-        unsigned count    = bytes[0];
-        unsigned address  = ((bytes[1] << 8) | bytes[2]);
-        int      type     = bytes[3];
-        unsigned cksum    = bytes[4 + count];
-        unsigned checksum = 0;
+                if (pOut == nullptr)
+                {
+                    LOG(ERROR) << "Record at 0x" << std::hex << base
+                               << " is outside the address space";
+                    break;
+                }
 
-        // Parse the data
-        for (unsigned ii = 0; ii < count; ++ii)
-            data.push_back(bytes[4 + ii]);
+                // Decode straight into the image
+                if (!isp::HexDecoder::decode(pData, count, pOut, sum))
+                    break;
+            }
+        }
+        else
+        {
+            // Control records carry at most four bytes
+            if ((count > sizeof(data)) || !isp::HexDecoder::decodeScalar(pData, count, data, sum))
+                break;
+        }
 
-        // Calculate the checksum
-        for (unsigned ii = 0; ii < bytes.size() - 1; ++ii)
-            checksum += bytes[ii];
-        checksum = (~(checksum - 1) & 0xFF);
+        if (!isp::HexDecoder::decodeScalar(pData + 2 * count, 1, &checksum, sum))
+            break;
 
-        // See if we got a match
-        if (checksum != cksum)
+        // The checksum makes the sum of every byte zero
+        if (sum & 0xFF)
         {
-            std::cerr << "Error checksum mismatch - inline: 0x"
-                      << std::hex << cksum
-                      << "  Calculated: 0x"
-                      << std::hex << checksum
-                      << std::endl;
+            LOG(ERROR) << "Error checksum mismatch - inline: 0x"
+                       << std::hex << static_cast<unsigned>(checksum)
+                       << "  Calculated: 0x"
+                       << std::hex << ((checksum - sum) & 0xFF);
             break;
         }
 
@@ -116,14 +204,16 @@ bool isp::iHex::process(std::string& line)
         {
             case 0: // Data
             {
-                if ((mOffsetAddress + address) < mStartAddress)
-                    mStartAddress = address;
+                uint32_t base = mOffsetAddress + address;
 
-                if ((mOffsetAddress + address + count - 1) > mEndAddress)
-                    mEndAddress = (mOffsetAddress + address + count - 1);
+                if (count == 0)
+                    break;
+
+                if (base < mStartAddress)
+                    mStartAddress = base;
 
-                for (unsigned ii = 0; ii < data.size(); ++ii)
-                    mpMemory[ mOffsetAddress + address + ii] = data[ ii ];
+                if ((base + count - 1) > mEndAddress)
+                    mEndAddress = (base + count - 1);
             }
             break;
 
@@ -135,7 +225,7 @@ bool isp::iHex::process(std::string& line)
                           << "  ending address: 0x"
                           << std::hex << mEndAddress;
                 doChecksum();
-                return result;
+                mIsEnd = true;
             }
             break;
 
@@ -189,9 +279,12 @@ bool isp::iHex::process(std::string& line)
 //
 void isp::iHex::doChecksum()
 {
-    uint32_t * pAddress = reinterpret_cast<uint32_t *>(mpMemory);
+    uint32_t * pAddress = reinterpret_cast<uint32_t *>(mImage.getData(0U, 8 * sizeof(uint32_t)));
     uint32_t checksum = 0U;
 
+    if (pAddress == nullptr)
+        return;
+
     for (unsigned ii = 0; ii < 7; ++ii)
         checksum += *(pAddress + ii);
     pAddress[7] = (~checksum + 1);
@@ -8,18 +8,21 @@
 #define IHEX_HPP
 
 //  Includes
-#include <iostream>
-#include <fstream>
+#include <stdint.h>
+#include <stddef.h>
 #include <string>
+#include "FirmwareImage.hh"
 
 //  Namespace
 namespace isp {
 
 ///
-/// @brief      Delta list class for the TR-069 client.
+/// @brief      Intel Hex file loader.
 ///
-/// @details    This class contains the support methods necessary to implement
-///             a delta-list scheduler for client threading support.
+/// @details    The file is mapped and decoded in a single pass straight into
+///             the firmware image, with each record checksum validated as it
+///             is decoded.  Hex digits may be upper or lower case and lines
+///             may end in LF or CR-LF.
 ///
 class iHex
 {
@@ -33,13 +36,10 @@ public:
     ///             The string for the filename; can be ether a filename in
     ///             the current directory or a full path.
     ///
-    /// @param[in]  pMemory
-    ///             The memory block to be filled in.
+    /// @param[in]  image
+    ///             The firmware image to be filled in.
     ///
-    /// @param[in]  size
-    ///             The size of the memory block in bytes.
-    ///
-    iHex(const char * filename, uint8_t * pMemory, size_t size);
+    iHex(const char * filename, FirmwareImage& image);
 
     ///
     /// @brief      Default destructor.
@@ -52,26 +52,22 @@ public:
     /// @brief      Parse the file contents.
     ///
     /// @details    Parse the entire file and determine the range
-    ///             for the addresses.
+    ///             for the addresses.  Parsing stops at the end of file
+    ///             record.
     ///
     /// @retval     true    Indicates success.
-    /// @retval     false   Indicates an error was encountered.
+    /// @retval     false   Indicates an error was encountered; a malformed
+    ///                     record, a checksum mismatch or data past the end
+    ///                     of the address space.
     ///
     bool parse();
 
-    ///
-    /// @brief      Process the Intel Hex line.
-    ///
-    /// @details    Process each Intel Hex record.
-    ///
-    /// @retval     true    Indicates success.
-    /// @retval     false   Indicates an error was encountered.
-    ///
-    bool process(std::string& line);
-
     ///
     /// @brief      Calculate 2's compliment checksum for the application.
     ///
+    /// @details    The vector table is only patched when the image holds
+    ///             it.
+    ///
     void doChecksum();
 
     ///
@@ -123,12 +119,31 @@ private:
     ///
     iHex& operator = (const iHex& ihex) = delete;
 
+    ///
+    /// @brief      Process the Intel Hex record.
+    ///
+    /// @details    Decode one record, without its leading ':' or line
+    ///             ending.  Data records are decoded straight into the
+    ///             firmware image.
+    ///
+    /// @param[in]  pRecord
+    ///             The hex digits of the record.
+    ///
+    /// @param[in]  length
+    ///             The number of hex digits.
+    ///
+    /// @retval     true    Indicates success.
+    /// @retval     false   Indicates an error was encountered.
+    ///
+    bool process(const uint8_t * pRecord, size_t length);
+
     //  Data Members
     std::string     mFilename;
     uint32_t        mOffsetAddress;
     uint32_t        mStartAddress;
     uint32_t        mEndAddress;
-    uint8_t *       mpMemory;
+    FirmwareImage&  mImage;
+    bool            mIsEnd;
 };
 }
 #endif